@@ -688,7 +688,7 @@ class DisplayOrder {
                             </div>
                           </div>
                           <div class="row">
-                            <trade-list (onTradesChartData)="onTradesChartData($event)" (onTradesMatchedLength)="onTradesMatchedLength($event)" (onTradesLength)="onTradesLength($event)" [product]="product" [setQuotingParameters]="pair.quotingParameters.display" [setTrade]="Trade"></trade-list>
+                            <trade-list (onOlderTrades)="onOlderTrades($event)" (onTradesChartData)="onTradesChartData($event)" [product]="product" [setQuotingParameters]="pair.quotingParameters.display" [setTrade]="Trade"></trade-list>
                           </div>
                         </div>
                       </div>
@@ -702,7 +702,7 @@ class DisplayOrder {
     </div>
     <address class="text-center">
       <small>
-        <a href="{{ homepage }}/blob/master/README.md" target="_blank">README</a> - <a href="{{ homepage }}/blob/master/doc/MANUAL.md" target="_blank">MANUAL</a> - <a href="{{ homepage }}" target="_blank">SOURCE</a> - <span [hidden]="!ready"><span [hidden]="!product.inet"><span title="non-default Network Interface for outgoing traffic">{{ product.inet }}</span> - </span><span title="Server used RAM" style="margin-top: 6px;display: inline-block;">{{ server_memory }}</span> - <span title="Client used RAM" style="margin-top: 6px;display: inline-block;">{{ client_memory }}</span> - <span title="Database Size" style="margin-top: 6px;display: inline-block;">{{ db_size }}</span> - <span style="margin-top: 6px;display: inline-block;"><span title="{{ tradesMatchedLength===-1 ? 'Trades' : 'Pings' }} in memory">{{ tradesLength }}</span><span [hidden]="tradesMatchedLength < 0">/</span><span [hidden]="tradesMatchedLength < 0" title="Pongs in memory">{{ tradesMatchedLength }}</span></span> - <span title="Market Levels in memory (bids|asks)" style="margin-top: 6px;display: inline-block;">{{ bidsLength }}|{{ asksLength }}</span> - </span><a href="#" (click)="openMatryoshka()">MATRYOSHKA</a> - <a href="{{ homepage }}/issues/new?title=%5Btopic%5D%20short%20and%20sweet%20description&body=description%0Aplease,%20consider%20to%20add%20all%20possible%20details%20%28if%20any%29%20about%20your%20new%20feature%20request%20or%20bug%20report%0A%0A%2D%2D%2D%0A%60%60%60%0Aapp%20exchange%3A%20{{ product.exchange }}/{{ product.base+'/'+product.quote }}%0Aapp%20version%3A%20undisclosed%0AOS%20distro%3A%20undisclosed%0A%60%60%60%0A![300px-spock_vulcan-salute3](https://cloud.githubusercontent.com/assets/1634027/22077151/4110e73e-ddb3-11e6-9d84-358e9f133d34.png)" target="_blank">CREATE ISSUE</a> - <a href="https://earn.com/analpaper/" target="_blank">HELP</a> - <a title="irc://irc.freenode.net:6697/#tradingBot" href="irc://irc.freenode.net:6697/#tradingBot">IRC</a>|<a target="_blank" href="https://kiwiirc.com/client/irc.freenode.net:6697/?theme=cli#tradingBot" rel="nofollow">www</a>
+        <a href="{{ homepage }}/blob/master/README.md" target="_blank">README</a> - <a href="{{ homepage }}/blob/master/doc/MANUAL.md" target="_blank">MANUAL</a> - <a href="{{ homepage }}" target="_blank">SOURCE</a> - <span [hidden]="!ready"><span [hidden]="!product.inet"><span title="non-default Network Interface for outgoing traffic">{{ product.inet }}</span> - </span><span title="Server used RAM" style="margin-top: 6px;display: inline-block;">{{ server_memory }}</span> - <span title="Client used RAM" style="margin-top: 6px;display: inline-block;">{{ client_memory }}</span> - <span title="Database Size (last maintenance took {{ db_maint }}ms and reclaimed {{ db_freed }})" style="margin-top: 6px;display: inline-block;">{{ db_size }}</span> - <span style="margin-top: 6px;display: inline-block;"><span title="{{ tradesMatchedLength===-1 ? 'Trades' : 'Pings' }} in memory">{{ tradesLength }}</span><span [hidden]="tradesMatchedLength < 0">/</span><span [hidden]="tradesMatchedLength < 0" title="Pongs in memory">{{ tradesMatchedLength }}</span></span> - <span title="Market Levels in memory (bids|asks)" style="margin-top: 6px;display: inline-block;">{{ bidsLength }}|{{ asksLength }}</span> - </span><a href="#" (click)="openMatryoshka()">MATRYOSHKA</a> - <a href="{{ homepage }}/issues/new?title=%5Btopic%5D%20short%20and%20sweet%20description&body=description%0Aplease,%20consider%20to%20add%20all%20possible%20details%20%28if%20any%29%20about%20your%20new%20feature%20request%20or%20bug%20report%0A%0A%2D%2D%2D%0A%60%60%60%0Aapp%20exchange%3A%20{{ product.exchange }}/{{ product.base+'/'+product.quote }}%0Aapp%20version%3A%20undisclosed%0AOS%20distro%3A%20undisclosed%0A%60%60%60%0A![300px-spock_vulcan-salute3](https://cloud.githubusercontent.com/assets/1634027/22077151/4110e73e-ddb3-11e6-9d84-358e9f133d34.png)" target="_blank">CREATE ISSUE</a> - <a href="https://earn.com/analpaper/" target="_blank">HELP</a> - <a title="irc://irc.freenode.net:6697/#tradingBot" href="irc://irc.freenode.net:6697/#tradingBot">IRC</a>|<a target="_blank" href="https://kiwiirc.com/client/irc.freenode.net:6697/?theme=cli#tradingBot" rel="nofollow">www</a>
       </small>
     </address>
     <iframe id="matryoshka" style="margin:0px;padding:0px;border:0px;width:100%;height:0px;" src="about:blank"></iframe>
@@ -715,6 +715,8 @@ class ClientComponent implements OnInit {
   public server_memory: string;
   public client_memory: string;
   public db_size: string;
+  public db_maint: number;
+  public db_freed: string;
   public notepad: string;
   public ready: boolean;
   public showSettings: boolean = true;
@@ -736,6 +738,7 @@ class ClientComponent implements OnInit {
   public cancelAllOrders = () => {};
   public cleanAllClosedOrders = () => {};
   public cleanAllOrders = () => {};
+  public onOlderTrades = (cursor: object) => {};
   public toggleSettings = (showSettings:boolean) => {
     setTimeout(this.resizeMatryoshka, 100);
   };
@@ -831,11 +834,13 @@ class ClientComponent implements OnInit {
       .getSubscriber(this.zone, Models.Topics.TradeSafetyValue)
       .registerSubscriber((o: Models.TradeSafety) => { this.TradeSafety = o; });
 
-    this.subscriberFactory
+    const trades = this.subscriberFactory
       .getSubscriber(this.zone, Models.Topics.Trades)
       .registerSubscriber((o: Models.Trade) => { this.Trade = o; })
       .registerDisconnectedHandler(() => { this.Trade = null; });
 
+    this.onOlderTrades = (cursor: object) => trades.page(cursor);
+
     this.subscriberFactory
       .getSubscriber(this.zone, Models.Topics.MarketData)
       .registerSubscriber((o: Models.Market) => { this.MarketData = o; })
@@ -903,12 +908,6 @@ class ClientComponent implements OnInit {
   public onTradesChartData(tradesChart: Models.TradeChart) {
     this.TradesChartData = tradesChart;
   }
-  public onTradesLength(tradesLength: number) {
-    this.tradesLength = tradesLength;
-  }
-  public onTradesMatchedLength(tradesMatchedLength: number) {
-    this.tradesMatchedLength = tradesMatchedLength;
-  }
   public onBidsLength(bidsLength: number) {
     this.bidsLength = bidsLength;
   }
@@ -931,6 +930,10 @@ class ClientComponent implements OnInit {
     this.server_memory = this.bytesToSize(o.memory, 0);
     this.client_memory = this.bytesToSize((<any>window.performance).memory ? (<any>window.performance).memory.usedJSHeapSize : 1, 0);
     this.db_size = this.bytesToSize(o.dbsize, 0);
+    this.db_maint = o.dbmaint;
+    this.db_freed = this.bytesToSize(o.dbfreed, 0);
+    this.tradesLength = o.trades;
+    this.tradesMatchedLength = o.pongs;
     this.tradeFreq = (o.freq);
     this.user_theme = this.user_theme!==null ? this.user_theme : (o.theme==1 ? '' : (o.theme==2 ? '-dark' : this.user_theme));
     this.system_theme = this.getTheme((new Date).getHours());
@@ -939,7 +942,7 @@ class ClientComponent implements OnInit {
   }
 
   private setTheme = () => {
-    if ((<any>document.getElementById('daynight').attributes).href.value!='/css/bootstrap-theme'+this.system_theme+'.min.css')
+    if (!(<any>document.getElementById('daynight').attributes).href.value.endsWith('/css/bootstrap-theme'+this.system_theme+'.min.css'))
       (<any>document.getElementById('daynight').attributes).href.value = '/css/bootstrap-theme'+this.system_theme+'.min.css';
   }
 
@@ -244,7 +244,7 @@ export class ProductAdvertisement {
 }
 
 export class ApplicationState {
-    constructor(public addr: string, public freq: number, public theme: number, public memory: number, public dbsize: number) { }
+    constructor(public addr: string, public freq: number, public theme: number, public memory: number, public dbsize: number, public dbmaint: number, public dbfreed: number, public trades: number, public pongs: number) { }
 }
 
 export class TradeSafety {
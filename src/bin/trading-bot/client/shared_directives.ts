@@ -41,6 +41,10 @@ class EvalAsyncSubscriber<T> implements Subscribe.ISubscribe<T> {
       return this._wrapped.registerDisconnectedHandler(() => this._scope.run(handler));
     };
 
+    public page = (args: object) => {
+      this._wrapped.page(args);
+    };
+
     public get connected() { return this._wrapped.connected; }
 }
 
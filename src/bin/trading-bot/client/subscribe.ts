@@ -27,6 +27,7 @@ export interface ISubscribe<T> {
   registerSubscriber: (incrementalHandler: (msg: T) => void) => ISubscribe<T>;
   registerConnectHandler: (handler: () => void) => ISubscribe<T>;
   registerDisconnectedHandler: (handler: () => void) => ISubscribe<T>;
+  page: (args: object) => void;
   connected: boolean;
 }
 
@@ -66,6 +67,11 @@ export class Subscriber<T> extends Observable<T> implements ISubscribe<T> {
       socket.ws.send(Models.Prefixes.SNAPSHOT + this._topic);
   };
 
+  public page = (args: object) => {
+    if (this.connected)
+      socket.ws.send(Models.Prefixes.SNAPSHOT + this._topic + JSON.stringify(args));
+  };
+
   private onDisconnect = () => {
     if (this._disconnectHandler !== null)
       this._disconnectHandler();
@@ -7,7 +7,8 @@ import {FireFactory, BaseCurrencyCellComponent, QuoteCurrencyCellComponent} from
 
 @Component({
   selector: 'trade-list',
-  template: `<ag-grid-angular #tradeList class="ag-theme-fresh ag-theme-dark" style="height: 361px;width: 99.80%;" rowHeight="21" [gridOptions]="gridOptions" (cellClicked)="onCellClicked($event)"></ag-grid-angular>`
+  template: `<ag-grid-angular #tradeList class="ag-theme-fresh ag-theme-dark" style="height: 361px;width: 99.80%;" rowHeight="21" [gridOptions]="gridOptions" (cellClicked)="onCellClicked($event)"></ag-grid-angular>
+    <div class="text-center" [hidden]="!gridOptions.rowData || !oldest"><a href="#" title="Load the previous page of the history of trades" (click)="onOlderTrades.emit({until: oldest, time: oldestPing}); false">older trades</a></div>`
 })
 export class TradesComponent implements OnInit {
 
@@ -23,6 +24,10 @@ export class TradesComponent implements OnInit {
 
   private sortTimeout: number;
 
+  public oldest: number = 0;
+
+  public oldestPing: number = 0;
+
   @Input() product: Models.ProductAdvertisement;
 
   @Input() set setQuotingParameters(o: Models.QuotingParameters) {
@@ -36,20 +41,19 @@ export class TradesComponent implements OnInit {
       return r;
     });
     this.gridOptions.api.refreshHeader();
-    this.emitLengths();
   }
 
   @Input() set setTrade(o: Models.Trade) {
     if (o === null) {
       if (this.gridOptions.rowData)
         this.gridOptions.api.setRowData([]);
+      this.oldest = 0;
+      this.oldestPing = 0;
     }
     else this.addRowData(o);
   }
 
-  @Output() onTradesLength = new EventEmitter<number>();
-
-  @Output() onTradesMatchedLength = new EventEmitter<number>();
+  @Output() onOlderTrades = new EventEmitter<object>();
 
   @Output() onTradesChartData = new EventEmitter<Models.TradeChart>();
 
@@ -130,6 +134,11 @@ export class TradesComponent implements OnInit {
           this.gridOptions.api.updateRowData({remove:[node.data]});
       });
     } else {
+      if (!this.oldest || (t.Ktime || t.time) < this.oldest
+        || ((t.Ktime || t.time) == this.oldest && t.time < this.oldestPing)) {
+        this.oldest = t.Ktime || t.time;
+        this.oldestPing = t.time;
+      }
       let exists: boolean = false;
       this.gridOptions.api.forEachNode((node: RowNode) => {
         if (!exists && node.data.tradeId==t.tradeId) {
@@ -195,17 +204,5 @@ export class TradesComponent implements OnInit {
     }
 
     this.gridOptions.api.sizeColumnsToFit();
-    this.emitLengths();
-  }
-
-  private emitLengths = () => {
-    this.onTradesLength.emit(this.gridOptions.api.getModel().getRowCount());
-    var tradesMatched: number = 0;
-    if (this.hasPongs) {
-      this.gridOptions.api.forEachNode((node: RowNode) => {
-        if (node.data.Kqty) tradesMatched++;
-      });
-    } else tradesMatched = -1;
-    this.onTradesMatchedLength.emit(tradesMatched);
   }
 }
@@ -61,6 +61,7 @@ class Engine: public Klass {
     mWalletPosition wallet;
             mBroker broker;
             mMemory memory;
+          mSnapshot snapshot;
   public:
     Engine()
       : qp(K)
@@ -69,7 +70,8 @@ class Engine: public Klass {
       , levels(K, qp, orders)
       , wallet(K, qp, orders, button, levels)
       , broker(K, qp, orders, button, levels, wallet)
-      , memory(K)
+      , memory(K, wallet.safety.trades)
+      , snapshot(K, orders, levels, wallet)
     {};
   protected:
     void waitData() override {
@@ -98,12 +100,19 @@ class Engine: public Klass {
       broker.semaphore.agree(K.arg<int>("autobot"));
     };
     void run() override {
+      levels.stats.ewma.waitForHistory(&K);
+      memory.waitForData(&K);
+      snapshot.load();
+      K.ending([&]() {
+        snapshot.save();
+      });
       K.timer_1s([&](const unsigned int &tick) {
         if (K.gateway->connected() and !levels.warn_empty()) {
           levels.timer_1s();
           if (!(tick % 60)) {
             levels.timer_60s();
             memory.timer_60s();
+            snapshot.save();
           }
           wallet.safety.timer_1s();
           calcQuotes();
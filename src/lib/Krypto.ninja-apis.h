@@ -76,6 +76,12 @@ namespace ₿ {
       {    "time", k.time    }
     };
   };
+  static void from_json(const json &j, mTrade &k) {
+    k.side     = j.value("side",     Side::Bid);
+    k.price    = j.value("price",    0.0);
+    k.quantity = j.value("quantity", 0.0);
+    k.time     = j.value("time", (Clock)0);
+  };
 
   struct mOrder: public mTrade {
            bool isPong          = false;
@@ -284,6 +290,7 @@ namespace ₿ {
       ) {
         if (!reply.valid())
           reply = ::async(launch::async, [this, event, read]() {
+            Loop::block_signals();
             vector<T1> data = read();
             event->wakeup();
             return data;
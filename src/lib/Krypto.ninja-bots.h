@@ -9,15 +9,14 @@ namespace ₿ {
   //! \brief     Call all endingFn once and print a last log msg.
   //! \param[in] reason Allows any (colorful?) string.
   //! \param[in] reboot Allows a reboot only because https://tldp.org/LDP/Bash-Beginners-Guide/html/sect_09_03.html.
-  void exit(const string &reason = "", const bool &reboot = false) {
-    epilogue = reason + string((reason.empty() or reason.back() == '.') ? 0 : 1, '.');
-    raise(reboot ? SIGTERM : SIGQUIT);
-  };
+  void exit(const string &reason = "", const bool &reboot = false);
 
   function<void(CURL*)> Curl::global_setopt = [](CURL *curl) {
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "K");
   };
 
+  atomic<unsigned long long> WebServer::sent = {0};
+
   class Ansi {
     public:
       static int colorful;
@@ -117,6 +116,7 @@ namespace ₿ {
       };
       static void repaint() {
         if (!display) return;
+        lock_guard<recursive_mutex> lock(printing);
         display();
         wrefresh(stdscr);
         if (stdlog) {
@@ -153,6 +153,7 @@ namespace ₿ {
         return "";
       };
       static void log(const string &prefix, const string &reason, const string &highlight = "") {
+        lock_guard<recursive_mutex> lock(printing);
         int color = 0;
         if (reason.find("NG TRADE") != string::npos) {
           if (reason.find("BUY") != string::npos)       color = 1;
@@ -193,6 +194,7 @@ namespace ₿ {
         wrefresh(stdlog);
       };
       static void logWar(const string &prefix, const string &reason) {
+        lock_guard<recursive_mutex> lock(printing);
         if (!display) {
           clog << stamp()
                << prefix          << Ansi::r(COLOR_RED)
@@ -218,10 +220,16 @@ namespace ₿ {
         wattroff(stdlog, COLOR_PAIR(COLOR_WHITE));
         wrefresh(stdlog);
       };
+    private:
+      //! \brief Serializes output from other threads (like the UI thread);
+      //!        recursive because ending handlers may print from a signal.
+      static recursive_mutex printing;
   };
 
   WINDOW *Print::stdlog = nullptr;
 
+  recursive_mutex Print::printing;
+
   Margin Print::margin = {ANY_NUM, 0, 0, 0};
 
   void (*Print::display)() = nullptr;
@@ -277,14 +285,16 @@ namespace ₿ {
   class Ending: public Rollout {
     private:
       static vector<function<void()>> endingFn;
+      static Loop::Async *event;
+      static volatile sig_atomic_t signaled;
     public:
       Ending() {
         signal(SIGINT, [](const int) {
           clog << '\n';
           raise(SIGQUIT);
         });
-        signal(SIGQUIT, die);
-        signal(SIGTERM, err);
+        signal(SIGQUIT, later);
+        signal(SIGTERM, later);
         signal(SIGABRT, wtf);
         signal(SIGSEGV, wtf);
         signal(SIGUSR1, wtf);
@@ -293,7 +303,28 @@ namespace ₿ {
       void ending(const function<void()> &fn) {
         endingFn.push_back(fn);
       };
+      //! \brief     Call all endingFn from the calling thread.
+      static void quit(const bool &reboot) {
+        if (reboot) err(SIGTERM);
+        else die(SIGQUIT);
+      };
+    protected:
+      //! \brief     Call all endingFn of quit signals from the event loop,
+      //!            where they are free to lock mutexes and join threads.
+      //! \param[in] loop Event loop that receives the quit signals.
+      void ending(Loop *const loop) {
+        event = loop->async([]() {
+          if (signaled) later(signaled);
+        });
+      };
     private:
+      static void later(const int sig) {
+        if (event and !signaled) {
+          signaled = sig;
+          event->wakeup();
+        } else if (sig == SIGTERM) err(sig);
+        else die(sig);
+      };
       static void halt(const int code) {
         vector<function<void()>> happyEndingFn;
         endingFn.swap(happyEndingFn);
@@ -367,6 +398,15 @@ namespace ₿ {
          << string(epilogue.empty() ? 0 : 1, '\n');
   } };
 
+  Loop::Async *Ending::event = nullptr;
+
+  volatile sig_atomic_t Ending::signaled = 0;
+
+  void exit(const string &reason, const bool &reboot) {
+    epilogue = reason + string((reason.empty() or reason.back() == '.') ? 0 : 1, '.');
+    Ending::quit(reboot);
+  };
+
   class Option {
     private_friend:
       struct Argument {
@@ -406,11 +446,13 @@ namespace ₿ {
         if (!arg<int>("naked")) long_options.push_back(
           {"naked",        "1",      nullptr,  "do not display CLI, print output to stdout instead"}
         );
-        if (databases) long_options.push_back(
+        if (databases) for (const Argument &it : (vector<Argument>){
           {"database",     "FILE",   "",       "set alternative PATH to database filename,"
                                                "\n" "default PATH is '/var/lib/K/db/K-*.db',"
-                                               "\n" "or use ':memory:' (see sqlite.org/inmemorydb.html)"}
-        );
+                                               "\n" "or use ':memory:' (see sqlite.org/inmemorydb.html)"},
+          {"db-msgpack",   "1",      nullptr,  "save database rows as binary MessagePack instead of JSON text,"
+                                               "\n" "existing rows are converted on boot (both ways)"}
+        }) long_options.push_back(it);
         if (!arg<int>("headless")) for (const Argument &it : (vector<Argument>){
           {"headless",     "1",      nullptr,  "do not listen for UI connections,"
                                                "\n" "all other UI related arguments will be ignored"},
@@ -419,6 +461,12 @@ namespace ₿ {
                                                "\n" "alien IPs will get a zip-bomb instead"},
           {"client-limit", "NUMBER", "7",      "set NUMBER of maximum concurrent UI connections"},
           {"port",         "NUMBER", "3000",   "set NUMBER of an open port to listen for UI connections"},
+          {"ws-deflate",   "NUMBER", "512",    "set NUMBER of minimum bytes of UI messages to compress"
+                                               "\n" "with permessage-deflate, '0' disables compression"},
+          {"ui-thread",    "1",      nullptr,  "serve UI connections from a dedicated thread,"
+                                               "\n" "away from the trading loop (Linux only)"},
+          {"metrics",      "WORD",   "",       "set WORD as user:pass to serve Prometheus metrics at /metrics,"
+                                               "\n" "or 'NULL' to serve them without authorization"},
           {"user",         "WORD",   "NULL",   "set allowed WORD as username for UI connections,"
                                                "\n" "mandatory but may be 'NULL'"},
           {"pass",         "WORD",   "NULL",   "set allowed WORD as password for UI connections,"
@@ -568,6 +616,10 @@ namespace ₿ {
             and arg<string>("pass") != "NULL" and !arg<string>("pass").empty()
           ) ? Text::B64(arg<string>("user") + ':' + arg<string>("pass"))
             : "";
+          args["B64metrics"] = (!arg<int>("headless")
+            and arg<string>("metrics") != "NULL" and !arg<string>("metrics").empty()
+          ) ? Text::B64(arg<string>("metrics"))
+            : "";
         }
       };
       void help(const vector<Argument> &long_options) {
@@ -654,6 +706,7 @@ namespace ₿ {
       };
       void launch_keylogger() {
         keylogger = ::async(launch::async, [&]() {
+          Loop::block_signals();
           int ch = ERR;
           while (ch == ERR and Print::display)
             ch = getch();
@@ -690,11 +743,106 @@ namespace ₿ {
       virtual json blob() const = 0;
   };
 
+  //! \brief Counters of hot paths, rendered as Prometheus text for /metrics.
+  //! - Only atomics, so a scrape never takes a lock from the trading loop.
+  class Metrics {
+    public_friend:
+      class Histogram {
+        private:
+          static constexpr Clock bounds[] = {1, 5, 10, 25, 50, 100, 250, 500, 1000, 2500, 5000};
+          atomic<unsigned long long> buckets[size(bounds) + 1] = {},
+                                     sum = {0};
+        public:
+          void observe(const Clock &ms) {
+            ++buckets[lower_bound(begin(bounds), end(bounds), ms) - begin(bounds)];
+            sum += max((Clock)0, ms);
+          };
+          string text(const string &name, const string &help) const {
+            string text = "# HELP " + name + ' ' + help + '\n'
+                        + "# TYPE " + name + " histogram"    + '\n';
+            unsigned long long count = 0;
+            for (size_t i = 0; i < size(buckets); ++i)
+              text += name + "_bucket{le=\"" + (
+                i < size(bounds) ? seconds(bounds[i]) : "+Inf"
+              ) + "\"} " + to_string(count += buckets[i]) + '\n';
+            return text
+              + name + "_sum "   + seconds(sum)     + '\n'
+              + name + "_count " + to_string(count) + '\n';
+          };
+      };
+    public:
+      static atomic<unsigned long long> topics[128],
+                                        levels,
+                                        quotes,
+                                        placed,
+                                        replaced,
+                                        cancelled;
+      static                  Histogram acked,
+                                        committed;
+    private:
+      static atomic<Clock> beaten,
+                           lag;
+    public:
+      //! \brief Call once per second from the loop to measure its lag.
+      static void beat() {
+        const Clock now = Tstamp;
+        if (beaten) lag = max((Clock)0, now - beaten - 1000);
+        beaten = now;
+      };
+      static string text(const int &clients) {
+        string text = "# HELP k_ui_messages_total UI messages broadcast per topic."   "\n"
+                      "# TYPE k_ui_messages_total counter"                             "\n";
+        for (size_t i = 0; i < size(topics); ++i)
+          if (topics[i])
+            text += "k_ui_messages_total{topic=\"" + string(1, (char)i) + "\"} "
+                  + to_string(topics[i]) + '\n';
+        return text
+          + counter("k_book_updates_total",    "Order book updates from the exchange.", levels)
+          + counter("k_quote_calcs_total",     "Quotes calculated.",                    quotes)
+          + counter("k_orders_placed_total",   "Orders sent to the exchange.",          placed)
+          + counter("k_orders_replaced_total", "Orders replaced at the exchange.",      replaced)
+          + counter("k_orders_cancelled_total","Orders cancelled at the exchange.",     cancelled)
+          + acked.text("k_order_ack_latency_seconds",      "Time until the exchange acknowledged a new order.")
+          + committed.text("k_db_commit_latency_seconds",  "Time to commit a batch of database writes.")
+          + "# HELP k_loop_lag_seconds Delay of the last one second tick of the loop."        "\n"
+            "# TYPE k_loop_lag_seconds gauge"                                                 "\n"
+            "k_loop_lag_seconds " + seconds(lag)                                            + '\n'
+          + "# HELP k_ui_clients Connected UI clients."                                       "\n"
+            "# TYPE k_ui_clients gauge"                                                       "\n"
+            "k_ui_clients " + to_string(clients)                                            + '\n'
+          + counter("k_ui_sent_bytes_total",   "Bytes written to UI sockets.",          WebServer::sent);
+      };
+    private:
+      static string counter(const string &name, const string &help, const unsigned long long &value) {
+        return "# HELP " + name + ' ' + help      + '\n'
+             + "# TYPE " + name + " counter"      + '\n'
+             + name      + ' '  + to_string(value) + '\n';
+      };
+      static string seconds(const Clock &ms) {
+        const string fraction = to_string(1000 + ms % 1000);
+        return to_string(ms / 1000) + '.' + fraction.substr(1);
+      };
+  };
+
+  atomic<unsigned long long> Metrics::topics[128] = {},
+                             Metrics::levels      = {0},
+                             Metrics::quotes      = {0},
+                             Metrics::placed      = {0},
+                             Metrics::replaced    = {0},
+                             Metrics::cancelled   = {0};
+
+  Metrics::Histogram Metrics::acked,
+                     Metrics::committed;
+
+  atomic<Clock> Metrics::beaten = {0},
+                Metrics::lag    = {0};
+
   class Sqlite {
     public_friend:
       class Backup: public Blob {
         public:
           using Report = pair<bool, string>;
+          using Row    = vector<double>;
           function<void()> push
 #ifndef NDEBUG
             = [this]() { WARN("Y U NO catch " << (char)about() << " sqlite push?"); }
@@ -712,6 +860,14 @@ namespace ₿ {
           virtual string increment() const { return "NULL"; };
           virtual double limit()     const { return 0; };
           virtual Clock  lifetime()  const { return 0; };
+          //! \brief     Names of REAL columns to save rows into, instead of json.
+          virtual vector<string> columns() const { return {}; };
+          //! \brief     Convert a blob() into the values of columns().
+          virtual Row row(const json&) const { return {}; };
+          //! \brief     Append a row loaded from the values of columns().
+          virtual void load(const Row&, const Clock&) {};
+          //! \brief     Save columns() into a memory-mapped ring file instead.
+          virtual bool journal() const { return false; };
         protected:
           Report report(const bool &empty) const {
             string msg = empty
@@ -794,14 +950,194 @@ namespace ₿ {
             return to_string(size());
           };
       };
+#ifndef _WIN32
+      //! \brief     Append-only ring of fixed-size rows in a memory-mapped file.
+      class Journal {
+        private:
+          struct Header {
+                char magic[8];
+            uint64_t columns,
+                     capacity,
+                     head,
+                     tail;
+          };
+          const size_t columns  = 0,
+                       capacity = 1 << 17,
+                       offset   = 64,
+                       size     = (2 + columns) * sizeof(uint64_t);
+                   int fd       = -1;
+                Header *header  = nullptr;
+                  char *records = nullptr;
+        public:
+          Journal(const string &file, const size_t &n)
+            : columns(n)
+          {
+            const size_t bytes = offset + capacity * size;
+            if ((fd = ::open(file.data(), O_RDWR | O_CREAT, 0644)) == -1
+              or ftruncate(fd, bytes) == -1
+              or (header = (Header*)mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED
+            ) error("DB", "Unable to map " + file + ", " + strerror(errno));
+            records = (char*)header + offset;
+            if (string(header->magic, 8) != "K.series"
+              or header->columns  != columns
+              or header->capacity != capacity
+            ) {
+              memset(header, 0, bytes);
+              memcpy(header->magic, "K.series", 8);
+              header->columns  = columns;
+              header->capacity = capacity;
+            }
+            recover();
+          };
+          Journal(const Journal&) = delete;
+          Journal &operator=(const Journal&) = delete;
+          ~Journal() {
+            sync();
+            if (header and header != MAP_FAILED)
+              munmap(header, offset + capacity * size);
+            if (fd != -1) ::close(fd);
+          };
+          void sync() const {
+            if (header and header != MAP_FAILED)
+              msync(header, offset + capacity * size, MS_SYNC);
+          };
+          void write(Backup *const data) {
+            const json blob = data->blob();
+            if (!data->limit())
+              header->tail = header->head;
+            else if (data->lifetime())
+              expire(Tstamp - data->lifetime());
+            if (!blob.is_null())
+              append(data->row(blob), Tstamp);
+          };
+          void read(Backup *const data) const {
+            Backup::Row values(columns);
+            for (uint64_t i = header->tail; i < header->head; ++i) {
+              memcpy(values.data(), record(i) + 2 * sizeof(uint64_t), columns * sizeof(double));
+              data->load(values, time(i));
+            }
+          };
+          void expire(const Clock &before) {
+            while (header->tail < header->head and time(header->tail) < before)
+              ++header->tail;
+          };
+        private:
+          char *record(const uint64_t &i) const {
+            return records + (i % capacity) * size;
+          };
+          uint64_t sequence(const uint64_t &i) const {
+            uint64_t seq;
+            memcpy(&seq, record(i), sizeof(uint64_t));
+            return seq;
+          };
+          Clock time(const uint64_t &i) const {
+            Clock time;
+            memcpy(&time, record(i) + sizeof(uint64_t), sizeof(Clock));
+            return time;
+          };
+          void append(const Backup::Row &values, const Clock &time) {
+            const uint64_t i   = header->head,
+                           seq = i + 1;
+            memcpy(record(i) + sizeof(uint64_t), &time, sizeof(Clock));
+            memcpy(record(i) + 2 * sizeof(uint64_t), values.data(), columns * sizeof(double));
+            memcpy(record(i), &seq, sizeof(uint64_t));
+            header->head = seq;
+            if (header->head - header->tail > capacity)
+              header->tail = header->head - capacity;
+          };
+          //! \brief     Trust head and tail from the header, only pick up rows
+          //!            written past a stale head and skip torn rows at the tail.
+          void recover() {
+            if (header->tail > header->head)
+              header->tail = header->head;
+            while (sequence(header->head) == header->head + 1)
+              ++header->head;
+            if (header->head - header->tail > capacity)
+              header->tail = header->head - capacity;
+            while (header->tail < header->head and sequence(header->tail) != header->tail + 1)
+              ++header->tail;
+          };
+      };
+#endif
     protected:
       bool databases = false;
+    private:
+      struct Statement {
+        sqlite3_stmt *insert = nullptr,
+                     *erase  = nullptr,
+                     *expire = nullptr,
+                     *clear  = nullptr;
+      };
+      struct Loaded {
+                                       json rows = json::array();
+        vector<pair<sqlite3_int64, string>> convert;
+                                     string warning;
+                                      Clock elapsed = 0;
+      };
+      struct Write {
+        Statement statement;
+           string increment,
+                  json;
+     Backup::Row  values;
+             bool clear = false;
+            Clock time  = 0;
+      };
     private:
       sqlite3 *db = nullptr;
-      string disk = "main";
+      string disk = "main",
+             file;
+      bool binary = false;
       mutable vector<Backup*> tables;
+#ifndef _WIN32
+      list<Journal> journals;
+#endif
+      deque<Write> queue;
+      mutable vector<function<void()>> jobs;
+      mutable mutex writing;
+      mutable condition_variable pending;
+      thread writer;
+      bool quit = false;
+      unordered_map<sqlite3_stmt*, Clock> expires;
+      Clock maintained = 0;
+      atomic<Clock> maintenanceTime{0};
+      atomic<long long> reclaimed{0};
+      bool full = false;
+      const size_t queueWarn  = 1e+4,
+                   queueLimit = 1e+5;
+      const chrono::seconds flushInterval = chrono::seconds(1);
+      const Clock maintenanceInterval = 60e+3;
+    public:
+      //! \brief     Time spent and bytes reclaimed by the last maintenance.
+      pair<Clock, long long> maintenance() const {
+        return {maintenanceTime, reclaimed};
+      };
+      //! \brief     Run slow jobs in the DB thread, after pending writes.
+      //! \param[in] job Runs right away if the DB thread is not running.
+      void background(const function<void()> &job) const {
+        if (!writer.joinable()) return job();
+        {
+          lock_guard<mutex> lock(writing);
+          jobs.push_back(job);
+        }
+        pending.notify_one();
+      };
+      //! \brief     Calculate in the DB thread, after pending writes.
+      //! \param[in] job   Returns the result to wait for.
+      //! \param[in] event Wakeup of the event loop, once the result is ready.
+      template <typename T> future<T> background(const function<T()> &job, Loop::Async *const event) const {
+        const auto task = make_shared<packaged_task<T()>>(job);
+        background([task, event]() {
+          (*task)();
+          event->wakeup();
+        });
+        return task->get_future();
+      };
     protected:
-      void backups(const string &database, const string &diskdata) {
+      void backups(const string &database, const string &diskdata, const bool &msgpack) {
+        binary = msgpack;
+        file = diskdata.empty() ? database : diskdata;
+        struct stat st;
+        const bool existed = !stat(file.data(), &st) and st.st_size;
         if (sqlite3_open(database.data(), &db))
           error("DB", sqlite3_errmsg(db));
         Print::log("DB", "loaded OK from", database);
@@ -809,15 +1145,74 @@ namespace ₿ {
           exec("ATTACH '" + diskdata + "' AS " + (disk = "disk") + ";");
           Print::log("DB", "loaded OK from", diskdata);
         }
+        if (!existed)
+          exec("PRAGMA " + disk + ".auto_vacuum = INCREMENTAL;");
         exec("PRAGMA " + disk + ".journal_mode = WAL;"
              "PRAGMA " + disk + ".synchronous = NORMAL;");
-        for (auto &it : tables) {
-          report(it->pull(select(it)));
-          it->push = [this, it]() {
-            insert(it);
+        if (existed) {
+          sqlite3_stmt *stmt = prepare("PRAGMA " + disk + ".auto_vacuum;");
+          const bool incremental = sqlite3_step(stmt) == SQLITE_ROW
+                               and sqlite3_column_int(stmt, 0) == 2;
+          sqlite3_finalize(stmt);
+          if (!incremental) {
+            Print::logWar("DB", "Enabling incremental vacuum on " + file
+              + ", rebuilding the whole file once (may take a while)");
+            exec("PRAGMA " + disk + ".auto_vacuum = INCREMENTAL;"
+                 "VACUUM " + disk + ";");
+            Print::log("DB", "enabled incremental vacuum on", file);
+          }
+        }
+#ifndef _WIN32
+        if (file != ":memory:")
+          ring(file);
+#endif
+        for (auto &it : tables)
+          open(it);
+        vector<Loaded> loaded = load(database, diskdata);
+        for (size_t i = 0; i < tables.size(); ++i) {
+          Backup *const it = tables.at(i);
+          if (!loaded.at(i).warning.empty())
+            Print::logWar("DB", loaded.at(i).warning);
+          convert(it, loaded.at(i).convert);
+          report(it->pull(loaded.at(i).rows));
+          Print::log("DB", "read " + schema(it) + " in", to_string(loaded.at(i).elapsed) + "ms");
+          it->push = [this, it, statement = prepare(it)]() {
+            enqueue(it, statement);
           };
         }
         tables.clear();
+        maintained = Tstamp;
+        writer = thread([&]() {
+          Loop::block_signals();
+          unique_lock<mutex> lock(writing);
+          while (!quit) {
+            pending.wait_for(lock, flushInterval, [&]() {
+              return quit or !jobs.empty() or queue.size() >= queueWarn / 2;
+            });
+            commit(lock);
+            work(lock);
+            if (maintained + maintenanceInterval <= Tstamp)
+              maintain(lock);
+          }
+          commit(lock);
+          work(lock);
+          maintain(lock);
+        });
+      };
+      //! \brief     Sync memory-mapped series and stop the DB thread
+      //!            after it commits all pending writes.
+      void flush() {
+#ifndef _WIN32
+        for (const Journal &it : journals)
+          it.sync();
+#endif
+        if (!writer.joinable() or writer.get_id() == this_thread::get_id()) return;
+        {
+          lock_guard<mutex> lock(writing);
+          quit = true;
+        }
+        pending.notify_one();
+        writer.join();
       };
       void blackhole() {
         for (auto &it : tables)
@@ -831,37 +1226,329 @@ namespace ₿ {
           Print::logWar("DB", note.second);
         else Print::log("DB", note.second);
       };
-      json select(Backup *const data) {
+#ifndef _WIN32
+      void ring(const string &database) {
+        for (auto it = tables.begin(); it != tables.end();) {
+          Backup *const data = *it;
+          if (!data->journal() or data->columns().empty()) {
+            ++it;
+            continue;
+          }
+          const Clock started = Tstamp;
+          const string file = database + '.' + (char)data->about() + ".series";
+          journals.emplace_back(file, data->columns().size());
+          Journal *const journal = &journals.back();
+          if (data->lifetime())
+            journal->expire(Tstamp - data->lifetime());
+          journal->read(data);
+          report(data->pull(json::array()));
+          Print::log("DB", "read " + file + " in", to_string(Tstamp - started) + "ms");
+          data->push = [data, journal]() {
+            journal->write(data);
+          };
+          it = tables.erase(it);
+        }
+      };
+#endif
+      void open(Backup *const data) {
         const string table = schema(data);
-        json result = json::array();
-        exec(
-          create(table)
-          + truncate(table, data->lifetime())
-          + "SELECT json FROM " + table + " ORDER BY time ASC;",
-          &result
-        );
-        return result;
+        const vector<string> columns = data->columns();
+        if (columns.empty())
+          exec(create(table));
+        else {
+          if (legacy(table)) migrate(data, table, columns);
+          exec(create(table, columns));
+        }
+        exec(truncate(table, data->lifetime()));
+      };
+      vector<Loaded> load(const string &database, const string &diskdata) {
+        vector<Loaded> loaded(tables.size());
+        if (!diskdata.empty()) {
+          for (size_t i = 0; i < tables.size(); ++i)
+            loaded.at(i) = read(db, tables.at(i));
+          return loaded;
+        }
+        atomic<size_t> next(0);
+        vector<future<string>> pool(min(
+          tables.size(), (size_t)max(2u, min(4u, thread::hardware_concurrency()))
+        ));
+        for (auto &it : pool)
+          it = ::async(launch::async, [&]() {
+            Loop::block_signals();
+            sqlite3 *conn = nullptr;
+            string failed;
+            if (sqlite3_open_v2(database.data(), &conn, SQLITE_OPEN_READONLY, nullptr))
+              failed = sqlite3_errmsg(conn);
+            else for (size_t i; (i = next++) < tables.size();)
+              loaded.at(i) = read(conn, tables.at(i));
+            sqlite3_close(conn);
+            return failed;
+          });
+        string failed;
+        for (auto &it : pool) {
+          const string reason = it.get();
+          if (failed.empty()) failed = reason;
+        }
+        if (!failed.empty())
+          error("DB", failed);
+        return loaded;
+      };
+      Loaded read(sqlite3 *const conn, Backup *const data) const {
+        const Clock started = Tstamp;
+        const string table = schema(data);
+        const vector<string> columns = data->columns();
+        Loaded loaded;
+        sqlite3_stmt *stmt = nullptr;
+        if (columns.empty()) {
+          if (!(stmt = query("SELECT id,json FROM " + table + " ORDER BY time ASC;", conn, loaded.warning))) return loaded;
+          while (sqlite3_step(stmt) == SQLITE_ROW) {
+            loaded.rows.push_back(decode(stmt, 1));
+            if ((sqlite3_column_type(stmt, 1) == SQLITE_BLOB) != binary)
+              loaded.convert.emplace_back(sqlite3_column_int64(stmt, 0), encode(loaded.rows.back()));
+          }
+          sqlite3_finalize(stmt);
+        } else {
+          string select;
+          for (const string &it : columns)
+            select += it + ",";
+          if (!(stmt = query("SELECT " + select + "time FROM " + table + " ORDER BY time ASC;", conn, loaded.warning))) return loaded;
+          const int n = columns.size();
+          Backup::Row values(n);
+          while (sqlite3_step(stmt) == SQLITE_ROW) {
+            for (int i = 0; i < n; ++i)
+              values[i] = sqlite3_column_double(stmt, i);
+            data->load(values, sqlite3_column_int64(stmt, n));
+          }
+          sqlite3_finalize(stmt);
+        }
+        loaded.elapsed = Tstamp - started;
+        return loaded;
+      };
+      void convert(Backup *const data, const vector<pair<sqlite3_int64, string>> &rows) {
+        if (rows.empty()) return;
+        const string table = schema(data);
+        sqlite3_stmt *stmt = prepare("UPDATE " + table + " SET json = ? WHERE id = ?;");
+        exec("BEGIN;");
+        for (const auto &it : rows) {
+          bind(stmt, 1, it.second);
+          sqlite3_bind_int64(stmt, 2, it.first);
+          step(stmt);
+        }
+        exec("COMMIT;");
+        sqlite3_finalize(stmt);
+        Print::log("DB", "converted", to_string(rows.size()) + " rows of " + table
+          + " to " + (binary ? "msgpack" : "json") + " format");
+      };
+      bool legacy(const string &table) {
+        bool found = false;
+        sqlite3_stmt *stmt = prepare("PRAGMA " + table.substr(0, table.find('.'))
+          + ".table_info(" + table.substr(table.find('.') + 1) + ");");
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+          if (string((const char*)sqlite3_column_text(stmt, 1)) == "json")
+            found = true;
+        sqlite3_finalize(stmt);
+        return found;
+      };
+      void migrate(Backup *const data, const string &table, const vector<string> &columns) {
+        const string name = table.substr(table.find('.') + 1);
+        exec("BEGIN;"
+             "ALTER TABLE " + table + " RENAME TO " + name + "_json;"
+          + create(table, columns));
+        sqlite3_stmt *stmt = prepare("SELECT id,json,time FROM " + table + "_json ORDER BY time ASC;"),
+                     *into = prepare(insert(table, columns));
+        size_t n = 0;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+          const Backup::Row values = data->row(decode(stmt, 1));
+          sqlite3_bind_int64(into, 1, sqlite3_column_int64(stmt, 0));
+          for (size_t i = 0; i < values.size(); ++i)
+            sqlite3_bind_double(into, i + 2, values[i]);
+          sqlite3_bind_int64(into, values.size() + 2, sqlite3_column_int64(stmt, 2));
+          step(into);
+          ++n;
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_finalize(into);
+        exec("DROP TABLE " + table + "_json;"
+             "COMMIT;");
+        if (n) Print::log("DB", "converted", to_string(n) + " rows of " + table + " to typed columns");
+      };
+      Statement prepare(Backup *const data) {
+        const string table = schema(data);
+        const vector<string> columns = data->columns();
+        return {
+          prepare(columns.empty()
+            ? "INSERT INTO " + table + " (id,json) VALUES(?,?);"
+            : insert(table, columns)
+          ),
+          prepare("DELETE FROM " + table + " WHERE id = ?;"),
+          prepare("DELETE FROM " + table + " WHERE time < ?;"),
+          prepare("DELETE FROM " + table + ";")
+        };
+      };
+      sqlite3_stmt *prepare(const string &sql) const {
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql.data(), sql.length(), &stmt, nullptr) != SQLITE_OK)
+          error("DB", "SQLite error: " + (sqlite3_errmsg(db) + (" at " + sql)));
+        return stmt;
+      };
+      sqlite3_stmt *query(const string &sql, sqlite3 *const conn, string &warning) const {
+        sqlite3_stmt *stmt = nullptr;
+        if (sqlite3_prepare_v2(conn, sql.data(), sql.length(), &stmt, nullptr) != SQLITE_OK) {
+          warning = "SQLite error: " + (sqlite3_errmsg(conn) + (" at " + sql));
+          sqlite3_finalize(stmt);
+          stmt = nullptr;
+        }
+        return stmt;
       };
-      void insert(Backup *const data) {
-        const string table    = schema(data);
+      void enqueue(Backup *const data, const Statement &statement) {
         const json   blob     = data->blob();
-        const double limit    = data->limit();
         const Clock  lifetime = data->lifetime();
-        const string incr     = data->increment();
-        const string sql      = (
-          (incr != "NULL" or !limit or lifetime)
-            ? "DELETE FROM " + table + (
-              incr != "NULL"
-                ? " WHERE id = " + incr
-                : (limit ? " WHERE time < " + to_string(Tstamp - lifetime) : "")
-            ) + ";" : ""
-        ) + (
-          blob.is_null()
-            ? ""
-            : "INSERT INTO " + table
-              + " (id,json) VALUES(" + incr + ",'" + blob.dump() + "');"
-        );
-        exec(sql);
+        Write row;
+        row.statement = statement;
+        row.increment = data->increment();
+        row.clear     = row.increment == "NULL" and !data->limit();
+        if (!blob.is_null()) {
+          if (data->columns().empty())
+            row.json  = encode(blob);
+          else {
+            row.values = data->row(blob);
+            row.time   = Tstamp;
+          }
+        }
+        unique_lock<mutex> lock(writing);
+        if (row.increment == "NULL" and !row.clear and lifetime)
+          expires[statement.expire] = Tstamp - lifetime;
+        if (queue.size() >= queueLimit and !coalesce(row, schema(data))) return;
+        queue.push_back(move(row));
+        if (!full and queue.size() >= queueWarn) {
+          full = true;
+          Print::logWar("DB", "Write queue is growing past " + to_string(queueWarn)
+            + " rows, waiting for the disk to catch up");
+          pending.notify_one();
+        }
+      };
+      //! \brief     Make room in a full queue for a new row of the same table.
+      //! \return    False if the new row must be dropped instead.
+      bool coalesce(const Write &row, const string &table) {
+        const auto same = [&](const Write &write) {
+          return write.statement.insert == row.statement.insert;
+        };
+        if (row.clear) {
+          queue.erase(remove_if(queue.begin(), queue.end(), same), queue.end());
+          if (queue.size() < queueLimit) {
+            Print::logWar("DB", "Write queue is full, replaced pending rows of " + table);
+            return true;
+          }
+        } else {
+          const auto it = find_if(queue.begin(), queue.end(), [&](const Write &write) {
+            return same(write) and (row.increment == "NULL" or write.increment == row.increment);
+          });
+          if (it != queue.end()) {
+            Print::logWar("DB", "Write queue is full, " + string(row.increment == "NULL"
+              ? "dropped the oldest"
+              : "replaced a"
+            ) + " pending row of " + table);
+            queue.erase(it);
+            return true;
+          }
+        }
+        Print::logWar("DB", "Write queue is full, dropped a new row of " + table);
+        return false;
+      };
+      void commit(unique_lock<mutex> &lock) {
+        if (queue.empty()) return;
+        deque<Write> rows;
+        rows.swap(queue);
+        lock.unlock();
+        const Clock started = Tstamp;
+        exec("BEGIN;");
+        for (const Write &it : rows)
+          insert(it);
+        exec("COMMIT;");
+        Metrics::committed.observe(Tstamp - started);
+        lock.lock();
+        if (full and queue.size() < queueWarn / 2) {
+          full = false;
+          Print::log("DB", "write queue drained to", to_string(queue.size()) + " rows");
+        }
+      };
+      void work(unique_lock<mutex> &lock) {
+        if (jobs.empty()) return;
+        vector<function<void()>> todo;
+        todo.swap(jobs);
+        lock.unlock();
+        for (const auto &it : todo) it();
+        lock.lock();
+      };
+      void maintain(unique_lock<mutex> &lock) {
+        unordered_map<sqlite3_stmt*, Clock> expired;
+        expired.swap(expires);
+        lock.unlock();
+        const Clock started = Tstamp;
+        const long long size = fileSize();
+        if (!expired.empty()) {
+          exec("BEGIN;");
+          for (const auto &it : expired) {
+            sqlite3_bind_int64(it.first, 1, it.second);
+            step(it.first);
+          }
+          exec("COMMIT;");
+        }
+        exec("PRAGMA " + disk + ".incremental_vacuum;"
+             "PRAGMA " + disk + ".wal_checkpoint(TRUNCATE);");
+        reclaimed       = max(0LL, size - fileSize());
+        maintenanceTime = Tstamp - started;
+        maintained      = Tstamp;
+        lock.lock();
+      };
+      long long fileSize() const {
+        long long size = 0;
+        struct stat st;
+        for (const string &it : {file, file + "-wal"})
+          if (!stat(it.data(), &st)) size += st.st_size;
+        return size;
+      };
+      void insert(const Write &row) {
+        const Statement &statement = row.statement;
+        if (row.increment != "NULL") {
+          sqlite3_bind_text(statement.erase, 1, row.increment.data(), row.increment.length(), SQLITE_STATIC);
+          step(statement.erase);
+        } else if (row.clear)
+          step(statement.clear);
+        if (row.json.empty() and row.values.empty()) return;
+        if (row.increment != "NULL")
+          sqlite3_bind_text(statement.insert, 1, row.increment.data(), row.increment.length(), SQLITE_STATIC);
+        else sqlite3_bind_null(statement.insert, 1);
+        if (row.values.empty())
+          bind(statement.insert, 2, row.json);
+        else {
+          for (size_t i = 0; i < row.values.size(); ++i)
+            sqlite3_bind_double(statement.insert, i + 2, row.values[i]);
+          sqlite3_bind_int64(statement.insert, row.values.size() + 2, row.time);
+        }
+        step(statement.insert);
+      };
+      json decode(sqlite3_stmt *const stmt, const int &index) const {
+        const char *row = (const char*)sqlite3_column_blob(stmt, index);
+        return sqlite3_column_type(stmt, index) == SQLITE_BLOB
+          ? json::from_msgpack(row, row + sqlite3_column_bytes(stmt, index))
+          : json::parse(row, row + sqlite3_column_bytes(stmt, index));
+      };
+      string encode(const json &blob) const {
+        if (!binary) return blob.dump();
+        const vector<uint8_t> bytes = json::to_msgpack(blob);
+        return string(bytes.begin(), bytes.end());
+      };
+      void bind(sqlite3_stmt *const stmt, const int &index, const string &row) const {
+        if (binary)
+          sqlite3_bind_blob(stmt, index, row.data(), row.length(), SQLITE_STATIC);
+        else sqlite3_bind_text(stmt, index, row.data(), row.length(), SQLITE_STATIC);
+      };
+      void step(sqlite3_stmt *const stmt) {
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+          Print::logWar("DB", "SQLite error: " + (sqlite3_errmsg(db) + (" at " + string(sqlite3_sql(stmt)))));
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
       };
       string schema(Backup *const data) const {
         return (
@@ -876,22 +1563,35 @@ namespace ₿ {
           + "json  BLOB                                                                          NOT NULL,"
           + "time  TIMESTAMP DEFAULT (CAST((julianday('now') - 2440587.5)*86400000 AS INTEGER))  NOT NULL);";
       };
+      string create(const string &table, const vector<string> &columns) const {
+        string sql = "CREATE TABLE IF NOT EXISTS " + table + "("
+          + "id    INTEGER  PRIMARY KEY AUTOINCREMENT  NOT NULL,";
+        for (const string &it : columns)
+          sql += it + "  REAL                                NOT NULL,";
+        return sql
+          + "time  INTEGER                                NOT NULL);"
+          + "CREATE INDEX IF NOT EXISTS " + table + "_time ON "
+          + table.substr(table.find('.') + 1) + "(time);";
+      };
+      string insert(const string &table, const vector<string> &columns) const {
+        string names, values;
+        for (const string &it : columns) {
+          names  += it + ",";
+          values += "?,";
+        }
+        return "INSERT INTO " + table + " (id," + names + "time) VALUES(?," + values + "?);";
+      };
       string truncate(const string &table, const Clock &lifetime) const {
         return lifetime
           ? "DELETE FROM " + table + " WHERE time < " + to_string(Tstamp - lifetime) + ";"
           : "";
       };
-      void exec(const string &sql, json *const result = nullptr) {              // Print::log("DB DEBUG", sql);
+      void exec(const string &sql) {                                            // Print::log("DB DEBUG", sql);
         char* zErrMsg = nullptr;
-        sqlite3_exec(db, sql.data(), result ? write : nullptr, (void*)result, &zErrMsg);
+        sqlite3_exec(db, sql.data(), nullptr, nullptr, &zErrMsg);
         if (zErrMsg) Print::logWar("DB", "SQLite error: " + (zErrMsg + (" at " + sql)));
         sqlite3_free(zErrMsg);
       };
-      static int write(void *result, int argc, char **argv, char**) {
-        for (int i = 0; i < argc; ++i)
-          ((json*)result)->push_back(json::parse(argv[i]));
-        return 0;
-      };
   };
 
   class Client {
@@ -911,9 +1611,39 @@ namespace ₿ {
           virtual json hello() {
             return { blob() };
           };
+          virtual string dump() const {
+            return blob().dump();
+          };
+          //! \brief     Rows older than the ones sent in hello(), on request.
+          //! \param[in] j Arguments of the request, like the time to page before.
+          virtual json page(const json&) {
+            return nullptr;
+          };
           virtual bool realtime() const {
             return true;
           };
+          //! \brief Each broadcast is a row to append, not the whole state,
+          //!        so lagging clients can't skip it.
+          virtual bool delta() const {
+            return false;
+          };
+          //! \brief Serialized hello(), reused by new clients
+          //!        until the version changes (if cached).
+          const string &greet() {
+            if (!cached() or greeted != version) {
+              greeting = hello().dump();
+              greeted  = version;
+            }
+            return greeting;
+          };
+        protected:
+          size_t version = 1;
+          virtual bool cached() const {
+            return false;
+          };
+        private:
+          size_t greeted = 0;
+          string greeting;
       };
       template <typename T> class Broadcast: public Readable {
         public:
@@ -921,25 +1651,42 @@ namespace ₿ {
             : Readable(client)
           {};
           bool broadcast() {
-            if ((read_asap() or read_soon())
-              and (read_same_blob() or diff_blob())
-            ) {
-              if (read) read();
-              return true;
-            }
-            return false;
+            const bool changed = (read_asap() or read_soon())
+              and (read_same_blob() or diff_blob());
+            if (changed) ++version;
+            if (changed and read) read();
+            fresh = false;
+            return changed;
           };
           json blob() const override {
             return *(T*)this;
           };
+          string dump() const override {
+            return fresh ? last_blob : blob().dump();
+          };
         protected:
           Clock last_Tstamp = 0;
+          size_t last_hash = 0;
           string last_blob;
+          bool fresh = false;
           virtual bool read_same_blob() const {
             return true;
           };
+          //! \brief Cheap fingerprint of the broadcasted fields,
+          //!        or 0 to compare the serialized blob instead.
+          virtual size_t hash() const {
+            return 0;
+          };
+          template <typename... Args> static size_t combine(const Args&... args) {
+            size_t seed = 0;
+            ((seed ^= std::hash<Args>()(args) + 0x9E3779B9 + (seed << 6) + (seed >> 2)), ...);
+            return seed ?: 1;
+          };
           bool diff_blob() {
-            const string last = last_blob;
+            if (const size_t digest = hash())
+              return exchange(last_hash, digest) != digest;
+            const string last = move(last_blob);
+            fresh = true;
             return (last_blob = blob().dump()) != last;
           };
           virtual bool read_asap() const {
@@ -993,14 +1740,54 @@ namespace ₿ {
       mutable vector<Clickable*> clickable;
       mutable unordered_map<const Clickable*, vector<function<void(const json&)>>> clickFn;
       const pair<char, char> portal = {'=', '-'};
-      unordered_map<char, function<json()>> hello;
+      unordered_map<char, function<const string&()>> hello;
+      unordered_map<char, function<json(const json&)>> pages;
       unordered_map<char, function<void(const json&)>> kisses;
       unordered_map<char, string> queue;
+      unordered_map<string, shared_ptr<const string>> responses;
+      shared_ptr<const string> unauthorized,
+                               forbidden,
+                               notFound,
+                               teapot,
+                               crowded;
+      struct Request {
+                 string msg,
+                        addr;
+        promise<string> reply;
+      };
+      unique_ptr<Epoll> ui;
+      unique_ptr<Epoll::Async> outbound; // outlives ui->end(), called from its own callback
+      Loop::Async *inbound = nullptr;
+      thread worker;
+      mutex handover;
+      deque<unordered_map<char, string>> outbox;
+      deque<Request> inbox;
+      deque<pair<unsigned long, future<string>>> unanswered;
+      bool quit = false;
+      atomic<int> connected = {0};
     public:
-      void listen(const Option *const o, const curl_socket_t &loopfd) {
+      void listen(const Option *const o, Loop *const loop) {
         option = o;
+        prebuild();
+        if (option->arg<int>("ui-thread")) {
+#if defined _WIN32 or defined __APPLE__
+          Print::logWar("UI", "Ignored --ui-thread (unsupported on this platform)");
+#else
+          ui = make_unique<Epoll>();
+          inbound = loop->async([&]() {
+            answer();
+          });
+          outbound = make_unique<Epoll::Async>(ui->poll(), [&]() {
+            deliver();
+          });
+          ui->timer_1s([&](const unsigned int&) {
+            server.timeouts();
+            connected = server.clients();
+          });
+#endif
+        }
         if (!server.listen(
-          loopfd,
+          ui ? ui->poll() : loop->poll(),
           option->arg<string>("interface"),
           option->arg<int>("port"),
           option->arg<int>("ipv6"),
@@ -1008,7 +1795,9 @@ namespace ₿ {
             option->arg<string>("B64auth"),
             response,
             upgrade,
-            message
+            message,
+            (size_t)max(0, option->arg<int>("ws-deflate")),
+            deltas()
           }
         )) error("UI", "Unable to listen at port number " + to_string(option->arg<int>("port"))
              + " (may be already in use by another program)");
@@ -1019,6 +1808,10 @@ namespace ₿ {
           )) Print::logWar("UI", it);
         protocol  = server.protocol();
         Print::log("UI", "ready at", Text::strL(protocol) + "://" + wtfismyip + ":" + to_string(option->arg<int>("port")));
+        if (ui) worker = thread([&]() {
+          Loop::block_signals();
+          ui->walk();
+        });
       };
       void clicked(const Clickable *data, const json &j = nullptr) const {
         if (clickFn.find(data) != clickFn.end())
@@ -1030,17 +1823,20 @@ namespace ₿ {
       void broadcast(const unsigned int &tick) {
         if (delay and !(tick % delay))
           broadcast();
-        server.timeouts();
+        if (!ui) server.timeouts();
       };
       void welcome() {
         for (auto &it : readable) {
           it->read = [&]() {
-            if (server.idle()) return;
-            queue[(char)it->about()] = it->blob().dump();
+            if (idle()) return;
+            queue[(char)it->about()] = it->dump();
             if (it->realtime() or !delay) broadcast();
           };
-          hello[(char)it->about()] = [&]() {
-            return it->hello();
+          hello[(char)it->about()] = [&]() -> const string& {
+            return it->greet();
+          };
+          pages[(char)it->about()] = [&](const json &j) {
+            return it->page(j);
           };
         }
         readable.clear();
@@ -1058,7 +1854,23 @@ namespace ₿ {
         documents.clear();
       };
       void withoutGoodbye() {
-        server.purge();
+        if (ui) {
+          {
+            lock_guard<mutex> lock(handover);
+            quit = true;
+            for (auto &it : inbox)
+              it.reply.set_value(string());
+            inbox.clear();
+          }
+          outbound->wakeup();
+          if (!worker.joinable()) return;
+          if (worker.get_id() == this_thread::get_id())
+            worker.detach();
+          else {
+            worker.join();
+            outbound->stop();
+          }
+        } else server.purge();
       };
     private:
       void clicked(const Clickable *data, const function<void(const json&)> &fn) const {
@@ -1066,10 +1878,64 @@ namespace ₿ {
       };
       void broadcast() {
         if (queue.empty()) return;
-        if (!server.idle())
+        for (const auto &it : queue)
+          ++Metrics::topics[it.first & 0x7F];
+        if (ui) {
+          {
+            lock_guard<mutex> lock(handover);
+            outbox.push_back(move(queue));
+          }
+          outbound->wakeup();
+        } else if (!server.idle())
           server.broadcast(portal.second, queue);
         queue.clear();
       };
+      bool idle() const {
+        return ui ? !connected : server.idle();
+      };
+      string deltas() const {
+        string topics;
+        for (const Readable *const it : readable)
+          if (it->delta()) topics += (char)it->about();
+        return topics;
+      };
+      //! \brief Runs on the UI thread to send what the main thread queued,
+      //!        replies first and in the order they were asked.
+      void deliver() {
+        deque<unordered_map<char, string>> updates;
+        bool bye = false;
+        {
+          lock_guard<mutex> lock(handover);
+          updates.swap(outbox);
+          bye = quit;
+        }
+        while (!unanswered.empty()
+          and unanswered.front().second.wait_for(chrono::seconds(0)) == future_status::ready
+        ) {
+          server.reply(unanswered.front().first, unanswered.front().second.get());
+          unanswered.pop_front();
+        }
+        for (const auto &it : updates)
+          if (!server.idle())
+            server.broadcast(portal.second, it);
+        if (bye) {
+          unanswered.clear();
+          server.purge();
+          ui->end();
+        }
+      };
+      //! \brief Runs on the main thread to reply what the UI thread received.
+      void answer() {
+        deque<Request> requests;
+        {
+          lock_guard<mutex> lock(handover);
+          requests.swap(inbox);
+        }
+        for (auto &it : requests)
+          it.reply.set_value(reply(it.msg, it.addr));
+        if (!requests.empty())
+          outbound->wakeup();
+      };
       bool alien(const string &addr) {
         if (addr != "unknown"
           and !option->arg<string>("whitelist").empty()
@@ -1080,46 +1946,93 @@ namespace ₿ {
         }
         return false;
       };
+      void prebuild() {
+        const string html = "text/html; charset=UTF-8";
+        unordered_map<string, string> etags;
+        for (const auto &it : documents)
+          etags[it.first] = Text::SHA1(string(it.second.first, it.second.second)).substr(0, 16);
+        for (const auto &it : documents) {
+          const string leaf = it.first.substr(it.first.find_last_of('.') + 1);
+          const string type = leaf == "js"  ? "application/javascript; charset=UTF-8"
+                            : leaf == "css" ? "text/css; charset=UTF-8"
+                            : leaf == "ico" ? "image/x-icon"
+                            : leaf == "mp3" ? "audio/mpeg"
+                            : html;
+          string content(it.second.first, it.second.second);
+          if (it.first == "/") {
+            for (const auto &asset : etags) {
+              if (asset.first.length() < 2) continue;
+              const string relative = '"' + asset.first.substr(1) + '"',
+                           hashed   = "\"/" + asset.second + asset.first + '"';
+              for (
+                size_t pos = content.find(relative);
+                pos != string::npos;
+                pos = content.find(relative, pos + hashed.length())
+              ) content.replace(pos, relative.length(), hashed);
+            }
+            responses[it.first] = make_shared<const string>(server.document(
+              content, 200, type, Text::SHA1(content).substr(0, 16)
+            ));
+            continue;
+          }
+          responses[it.first] = make_shared<const string>(server.document(
+            content, 200, type, etags.at(it.first)
+          ));
+          if (!it.first.empty())
+            responses["/" + etags.at(it.first) + it.first] = make_shared<const string>(server.document(
+              content, 200, type, etags.at(it.first), true
+            ));
+        }
+        unauthorized = make_shared<const string>(server.document("", 401, html));
+        forbidden    = make_shared<const string>(server.document("", 403, html));
+        notFound     = make_shared<const string>(server.document("Today, is a beautiful day.", 404, html));
+        teapot       = make_shared<const string>(server.document("Today, is your lucky day!", 418, html));
+        crowded      = make_shared<const string>(server.document("Thank you! but our princess is already in this castle!"
+                                                                 "<br/>" "Refresh the page anytime to retry.", 200, html));
+      };
+      shared_ptr<const string> metrics(const string &auth, const string &addr) {
+        if (!option->arg<string>("B64metrics").empty()
+          and auth != option->arg<string>("B64metrics")
+        ) {
+          Print::log("UI", "metrics authorization failed from", addr);
+          return auth.empty() ? unauthorized : forbidden;
+        }
+        return make_shared<const string>(server.document(
+          Metrics::text(connected),
+          200,
+          "text/plain; version=0.0.4; charset=UTF-8"
+        ));
+      };
       WebServer::Response response = [&](string path, const string &auth, const string &addr) {
         if (alien(addr))
           path.clear();
+        else if (path.substr(0, path.find('?')) == "/metrics"
+          and !option->arg<string>("metrics").empty()
+        ) return metrics(auth, addr);
         const bool papersplease = !(path.empty() or option->arg<string>("B64auth").empty());
-        string content,
-               type = "text/html; charset=UTF-8";
-        unsigned int code = 200;
         const string leaf = path.substr(path.find_last_of('.') + 1);
         if (papersplease and auth.empty()) {
           Print::log("UI", "authorization attempt from", addr);
-          code = 401;
+          return unauthorized;
         } else if (papersplease and auth != option->arg<string>("B64auth")) {
           Print::log("UI", "authorization failed from", addr);
-          code = 403;
+          return forbidden;
         } else if (leaf != "/" or server.clients() < option->arg<int>("client-limit")) {
-          if (documents.find(path) == documents.end())
+          if (responses.find(path) == responses.end())
             path = path.substr(path.find_last_of("/", path.find_last_of("/") - 1));
-          if (documents.find(path) == documents.end())
+          if (responses.find(path) == responses.end())
             path = path.substr(path.find_last_of("/"));
-          if (documents.find(path) != documents.end()) {
-            content = string(documents.at(path).first,
-                             documents.at(path).second);
+          if (responses.find(path) != responses.end()) {
             if (leaf == "/") Print::log("UI", "authorization success from", addr);
-            else if (leaf == "js")  type = "application/javascript; charset=UTF-8";
-            else if (leaf == "css") type = "text/css; charset=UTF-8";
-            else if (leaf == "ico") type = "image/x-icon";
-            else if (leaf == "mp3") type = "audio/mpeg";
-          } else {
-            if (Random::int64() % 21)
-              code = 404, content = "Today, is a beautiful day.";
-            else // Humans! go to any random path to check your luck
-              code = 418, content = "Today, is your lucky day!";
-          }
-        } else {
-          Print::log("UI", "--client-limit=" + to_string(option->arg<int>("client-limit"))
-            + " reached by", addr);
-          content = "Thank you! but our princess is already in this castle!"
-                    "<br/>" "Refresh the page anytime to retry.";
+            return responses.at(path);
+          } else if (Random::int64() % 21)
+            return notFound;
+          else // Humans! go to any random path to check your luck
+            return teapot;
         }
-        return server.document(content, code, type);
+        Print::log("UI", "--client-limit=" + to_string(option->arg<int>("client-limit"))
+          + " reached by", addr);
+        return crowded;
       };
       WebServer::Upgrade upgrade = [&](const int &sum, const string &addr) {
         const int tentative = server.clients() + sum;
@@ -1130,17 +2043,36 @@ namespace ₿ {
             + " reached by", addr);
           return 0;
         }
+        connected = max(0, tentative);
         return sum;
       };
-      WebServer::Message message = [&](string msg, const string &addr) {
+      WebServer::Message message = [&](string msg, const string &addr, const unsigned long &client) {
+        if (!ui) return reply(msg, addr);
+        {
+          lock_guard<mutex> lock(handover);
+          if (quit) return string();
+          inbox.push_back({msg, addr, {}});
+          unanswered.emplace_back(client, inbox.back().reply.get_future());
+        }
+        inbound->wakeup();
+        return string();
+      };
+      string reply(string msg, const string &addr) {
         if (alien(addr))
           return string(documents.at("").first, documents.at("").second);
         const char matter = msg.at(1);
         if (portal.first == msg.at(0)) {
-          if (hello.find(matter) != hello.end()) {
-            const json reply = hello.at(matter)();
-            if (!reply.is_null())
-              return portal.first + (matter + reply.dump());
+          if (msg.length() > 2) {
+            msg = msg.substr(2);
+            if (pages.find(matter) != pages.end() and json::accept(msg)) {
+              const json reply = pages.at(matter)(json::parse(msg));
+              if (!reply.is_null())
+                return portal.first + (matter + reply.dump());
+            }
+          } else if (hello.find(matter) != hello.end()) {
+            const string &reply = hello.at(matter)();
+            if (reply != "null")
+              return portal.first + (matter + reply);
           }
         } else if (portal.second == msg.at(0) and kisses.find(matter) != kisses.end()) {
           msg = msg.substr(2);
@@ -1223,17 +2155,23 @@ namespace ₿ {
                           : "no"           }
           });
         } {
-          if (databases)
+          ending((Loop*)this);
+          if (databases) {
             backups(
               arg<string>("database"),
-              arg<string>("diskdata")
+              arg<string>("diskdata"),
+              arg<int>("db-msgpack")
             );
-          else blackhole();
+            ending([&]() {
+              flush();
+            });
+          } else blackhole();
         } {
           if (arg<int>("headless")) headless();
           else {
-            listen((Option*)this, poll());
+            listen((Option*)this, this);
             timer_1s([&](const unsigned int &tick) {
+              Metrics::beat();
               broadcast(tick);
             });
             ending([&]() {
@@ -6,12 +6,12 @@
 namespace ₿ {
   class WebSocketFrames {
     protected:
-      string frame(string data, const int &opcode, const bool &mask) const {
+      string frame(string data, const int &opcode, const bool &mask, const bool &deflated = false) const {
         const int key = mask ? rand() : 0;
         const int bit = mask ? 0x80   : 0;
         size_t pos = 0,
                len = data.length();
-                                data.insert(pos++  , 1,  opcode     | 0x80);
+                                data.insert(pos++  , 1,  opcode     | 0x80 | (deflated ? 0x40 : 0));
         if      (len <= 0x7D)   data.insert(pos++  , 1,  len        | bit );
         else if (len <= 0xFFFF) data.insert(pos    , 1, (char)(0x7E | bit))
                                     .insert(pos + 1, 1, (len >>  8) & 0xFF)
@@ -31,39 +31,110 @@ namespace ₿ {
         }
         return data;
       };
+      //! \brief     Frame a text message, compressed when it is not too small.
+      //! \param[in] deflate Minimum length to compress, or 0 to never compress.
+      string frame_deflate(const string &data, const size_t &deflate) const {
+        return deflate and data.length() >= deflate
+          ? frame(this->deflate(data), 0x01, false, true)
+          : frame(data, 0x01, false);
+      };
+      //! \brief Compress a permessage-deflate payload (RFC 7692),
+      //!        without context takeover, so any frame can be shared.
+      //! \note  The stream is reused and reset, so call it from one thread.
+      static string deflate(const string &data) {
+        static struct Stream: public z_stream {
+          bool ready = false;
+          Stream()
+            : z_stream()
+          {
+            ready = deflateInit2(this, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+          };
+          ~Stream() {
+            if (ready) deflateEnd(this);
+          };
+        } z;
+        string out;
+        if (!z.ready or deflateReset(&z) != Z_OK)
+          return out;
+        out.resize(deflateBound(&z, data.length()) + 6);
+        z.next_in   = (Bytef*)data.data();
+        z.avail_in  = data.length();
+        z.next_out  = (Bytef*)&out[0];
+        z.avail_out = out.length();
+        ::deflate(&z, Z_SYNC_FLUSH);
+        out.resize(out.length() - z.avail_out);
+        if (out.length() > 4) out.resize(out.length() - 4);
+        return out;
+      };
+      static string inflate(string data, const size_t &limit = 1 << 20) {
+        string out;
+        z_stream z = {};
+        if (inflateInit2(&z, -MAX_WBITS) != Z_OK)
+          return out;
+        data.append("\x00\x00\xFF\xFF", 4);
+        z.next_in  = (Bytef*)data.data();
+        z.avail_in = data.length();
+        int rc = Z_OK;
+        while (rc == Z_OK and z.avail_in and out.length() <= limit) {
+          char buf[16384];
+          z.next_out  = (Bytef*)buf;
+          z.avail_out = sizeof(buf);
+          rc = ::inflate(&z, Z_SYNC_FLUSH);
+          out.append(buf, sizeof(buf) - z.avail_out);
+        }
+        inflateEnd(&z);
+        if (out.length() > limit or (rc != Z_OK and rc != Z_STREAM_END and (rc != Z_BUF_ERROR or z.avail_in)))
+          out.clear();
+        return out;
+      };
       string unframe(string &data, string &pong, bool &drop) const {
+        size_t offset = 0;
+        const string msg = unframe(data, offset, pong, drop);
+        data.erase(0, offset);
+        return msg;
+      };
+      //! \brief     Parse the next frame in place, starting at offset.
+      //! \param[in] offset  Position of the next frame, moved past it once parsed.
+      //! \param[in] deflate Accept compressed messages (RFC 7692).
+      string unframe(string &data, size_t &offset, string &pong, bool &drop, const bool &deflate = false) const {
         string msg;
-        const size_t max = data.length();
+        const size_t max = data.length() - offset;
         if (max > 1) {
-          const bool flat = (data[0] & 0x40) != 0x40,
-                     mask = (data[1] & 0x80) == 0x80;
+          char *const frame = &data[offset];
+          const bool flat = (frame[0] & 0x40) != 0x40,
+                     mask = (frame[1] & 0x80) == 0x80,
+                     zlib = !flat and deflate and (frame[0] & 0x0F) < 0x08;
           const size_t key = mask ? 4 : 0;
-          size_t                            len =    data[1] & 0x7F,          pos = key;
-          if      (            len <= 0x7D)                                   pos += 2;
-          else if (max > 2 and len == 0x7E) len = (((data[2] & 0xFF) <<  8)
-                                                |   (data[3] & 0xFF)       ), pos += 4;
-          else if (max > 8 and len == 0x7F) len = (((data[6] & 0xFF) << 24)
-                                                |  ((data[7] & 0xFF) << 16)
-                                                |  ((data[8] & 0xFF) <<  8)
-                                                |   (data[9] & 0xFF)       ), pos += 10;
-          if (!flat or pos == key)
+          size_t                            len =    frame[1] & 0x7F,          pos = key;
+          if      (            len <= 0x7D)                                    pos += 2;
+          else if (max > 3 and len == 0x7E) len = (((frame[2] & 0xFF) <<  8)
+                                                |   (frame[3] & 0xFF)       ), pos += 4;
+          else if (max > 9 and len == 0x7F) len = (((frame[6] & 0xFF) << 24)
+                                                |  ((frame[7] & 0xFF) << 16)
+                                                |  ((frame[8] & 0xFF) <<  8)
+                                                |   (frame[9] & 0xFF)       ), pos += 10;
+          if (pos == key and len > 0x7D)
+            return msg;
+          if (!flat and !zlib)
             drop = true;
           else if (max >= pos + len) {
             if (mask)
               for (size_t i = 0; i < len; i++)
-                data.at(pos + i) ^= data.at(pos - key + (i % key));
-            const unsigned char opcode = data[0] & 0x0F;
+                frame[pos + i] ^= frame[pos - key + (i % key)];
+            const unsigned char opcode = frame[0] & 0x0F;
             if (opcode == 0x09)
-              pong += frame(data.substr(pos, len), 0x0A, !mask);
+              pong += this->frame(string(frame + pos, len), 0x0A, !mask);
             else if (opcode == 0x02
                   or opcode == 0x08
                   or opcode == 0x0A
-                  or ((data[0] & 0x80) != 0x80 and (opcode == 0x00
-                                                 or opcode == 0x01))
+                  or ((frame[0] & 0x80) != 0x80 and (opcode == 0x00
+                                                  or opcode == 0x01))
             ) drop = opcode == 0x08;
-            else
-              msg = data.substr(pos, len);
-            data = data.substr(pos + len);
+            else if (!zlib)
+              msg = string(frame + pos, len);
+            else if ((msg = inflate(string(frame + pos, len))).empty())
+              drop = true;
+            offset += pos + len;
           }
         }
         return msg;
@@ -165,6 +236,18 @@ namespace ₿ {
           virtual void change(const int&, const function<void()>& = nullptr) = 0;
       };
     public:
+      //! \brief     Leave signals to the thread that walks the loop,
+      //!            call it first in any other thread.
+      //! \note      Faults still reach the thread that caused them.
+      static void block_signals() {
+#ifndef _WIN32
+        sigset_t mask;
+        sigfillset(&mask);
+        sigdelset(&mask, SIGSEGV);
+        sigdelset(&mask, SIGABRT);
+        pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+#endif
+      };
       virtual          void  timer_ticks_factor(const unsigned int&) const        = 0;
       virtual          void  timer_1s(const function<void(const unsigned int&)>&) = 0;
       virtual         Async *async(const function<void()>&)                       = 0;
@@ -750,15 +833,19 @@ namespace ₿ {
 
   class WebServer {
     public_friend:
-      using Response = function<string(string, const string&, const string&)>;
+      using Response = function<shared_ptr<const string>(string, const string&, const string&)>;
       using Upgrade  = function<int(const int&, const string&)>;
-      using Message  = function<string(string, const string&)>;
+      using Message  = function<string(string, const string&, const unsigned long&)>;
+      //! \brief Bytes written to all UI sockets, readable from any thread.
+      static atomic<unsigned long long> sent;
     private_friend:
       struct Session {
           string auth;
         Response response = nullptr;
          Upgrade upgrade  = nullptr;
          Message message  = nullptr;
+          size_t deflate  = 0;
+          string deltas;
       };
       class Socket: public Epoll::Poll {
         public:
@@ -780,18 +867,29 @@ namespace ₿ {
       class Frontend: public Socket,
                       public WebSocketFrames {
         private:
-                    SSL *ssl     = nullptr;
-          const Session *session = nullptr;
-                  Clock  time    = 0;
-                 string  addr,
-                         out,
-                         in;
+                                                    SSL *ssl      = nullptr;
+                                          const Session *session  = nullptr;
+                                                 size_t  written  = 0,
+                                                         parsed   = 0,
+                                                         queued   = 0,
+                                                         backlog  = 0;
+                                                  Clock  time     = 0;
+                                          unsigned long  id       = 0;
+                                                   bool  zlib     = false;
+                                       static const int  chunk    = 16384;
+                                    static const size_t  budget   = 1 << 18,
+                                                         limit    = 1 << 22;
+                                                 string  addr,
+                                                         in;
+             deque<pair<shared_ptr<const string>, bool>> out;
+          unordered_map<char, shared_ptr<const string>>  latest;
         public:
-          Frontend(const curl_socket_t &s, const curl_socket_t &loopfd, SSL *S, const Session *e)
+          Frontend(const curl_socket_t &s, const curl_socket_t &loopfd, SSL *S, const Session *e, const unsigned long &i)
             : Socket(s)
             , ssl(S)
             , session(e)
             , time(Tstamp)
+            , id(i)
           {
             start(loopfd, ioHttp);
           };
@@ -806,9 +904,49 @@ namespace ₿ {
           Clock upgraded() const {
             return !time;
           };
-          void send(const string &data) {
-            out += data;
-            change(EPOLLIN | EPOLLOUT);
+          bool deflated() const {
+            return zlib;
+          };
+          bool is(const unsigned long &i) const {
+            return id == i;
+          };
+          void reply(const string &msg) {
+            if (msg.empty()) return;
+            send(make_shared<const string>(
+              msg.substr(0, 2) == "PK"
+                ? frame(msg, 0x02, false)
+                : frame_deflate(msg, zlib ? session->deflate : 0)
+            ));
+          };
+          //! \brief     Queue a frame to write.
+          //! \param[in] broadcasted Counts towards the hard limit of backlog;
+          //!            replies only check the limit before they are queued,
+          //!            so a big hello or page never drops the client.
+          void send(const shared_ptr<const string> &data, const bool &broadcasted = false) {
+            if (!sockfd) return;
+            if (!broadcasted and queued > limit)
+              shutdown();
+            else {
+              push(data, broadcasted);
+              if (backlog > limit)
+                shutdown();
+              else change(EPOLLIN | EPOLLOUT);
+            }
+          };
+          //! \brief Over budget, keep only the newest frame of each snapshot
+          //!        topic until the client reads what is already queued.
+          bool lagging() const {
+            return queued > budget or !latest.empty();
+          };
+          //! \brief Deltas (rows to append) are never conflated.
+          void conflate(const char &topic, const shared_ptr<const string> &data) {
+            if (!sockfd) return;
+            if (session->deltas.find(topic) != string::npos)
+              send(data, true);
+            else {
+              latest[topic] = data;
+              if (!writing()) flush();
+            }
           };
           bool stale() {
             if (time and sockfd and Tstamp > time + 21e+3)
@@ -818,25 +956,33 @@ namespace ₿ {
         protected:
           string unframe() {
             bool drop = false;
-            const string msg = WebSocketFrames::unframe(in, out, drop);
+            string pong;
+            const string msg = WebSocketFrames::unframe(in, parsed, pong, drop, zlib);
             if (drop) shutdown();
+            else if (!pong.empty()) send(make_shared<const string>(pong));
             return msg;
           };
         private:
           function<void()> ioWs = [&]() {
             io();
-            if (!sockfd or in.empty()) return;
-            const string msg = unframe();
-            if (msg.empty()) return;
-            const string reply = session->message(msg, addr);
-            if (reply.empty()) return;
-            out += frame(reply, reply.substr(0, 2) == "PK" ? 0x02 : 0x01, false);
-            change(EPOLLIN | EPOLLOUT);
+            for (size_t last = string::npos; sockfd and parsed < in.length() and parsed != last;) {
+              last = parsed;
+              const string msg = unframe();
+              if (msg.empty()) continue;
+              reply(session->message(msg, addr, id));
+            }
+            if (parsed == in.length()) {
+              in.clear();
+              parsed = 0;
+            } else if (parsed > in.length() / 2) {
+              in.erase(0, parsed);
+              parsed = 0;
+            }
           };
           function<void()> ioHttp = [&]() {
             io();
             if (sockfd
-              and out.empty()
+              and !writing()
               and in.length() > 5
               and in.substr(0, 5) == "GET /"
               and in.find("\r\n\r\n") != string::npos
@@ -853,10 +999,14 @@ namespace ₿ {
               const size_t key = in.find("Sec-WebSocket-Key: ");
               int allowed = 1;
               if (key == string::npos) {
-                out = session->response(path, auth, addr);
-                if (out.empty())
+                const shared_ptr<const string> document = session->response(path, auth, addr);
+                if (!document or document->empty())
                   shutdown();
-                else change(EPOLLIN | EPOLLOUT);
+                else {
+                  const shared_ptr<const string> headers = unmodified(document);
+                  push(headers ? headers : document);
+                  change(EPOLLIN | EPOLLOUT);
+                }
               } else if ((session->auth.empty() or auth == session->auth)
                 and in.find("\r\n" "Upgrade: websocket" "\r\n") != string::npos
                 and in.find("\r\n" "Connection: ")              != string::npos
@@ -865,7 +1015,15 @@ namespace ₿ {
                 and (allowed = session->upgrade(allowed, addr))
               ) {
                 time = 0;
-                out = "HTTP/1.1 101 Switching Protocols"
+                const size_t extensions = in.find("Sec-WebSocket-Extensions: ");
+                if (session->deflate and extensions != string::npos) {
+                  string offer = in.substr(extensions + 26);
+                  offer = offer.substr(0, offer.find_first_of(",\r"));
+                  zlib = offer.find("permessage-deflate") == 0
+                     and offer.find("server_max_window_bits") == string::npos;
+                }
+                push(make_shared<const string>(
+                      "HTTP/1.1 101 Switching Protocols"
                       "\r\n" "Connection: Upgrade"
                       "\r\n" "Upgrade: websocket"
                       "\r\n" "Sec-WebSocket-Version: 13"
@@ -874,9 +1032,13 @@ namespace ₿ {
                                  in.substr(key + 19, in.substr(key + 19).find("\r\n"))
                                    + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11",
                                  true
-                               )) +
+                               ))
+                    + (zlib ? "\r\n" "Sec-WebSocket-Extensions: permessage-deflate"
+                                        "; server_no_context_takeover"
+                                        "; client_no_context_takeover" : "") +
                       "\r\n"
-                      "\r\n";
+                      "\r\n"
+                ));
                 in.clear();
                 change(EPOLLIN | EPOLLOUT, ioWs);
               } else {
@@ -885,6 +1047,22 @@ namespace ₿ {
               }
             }
           };
+          //! \brief Headers only, if the browser already has this ETag.
+          shared_ptr<const string> unmodified(const shared_ptr<const string> &document) const {
+            const size_t match  = in.find("\r\n" "If-None-Match: "),
+                         status = document->find("\r\n"),
+                         body   = document->find("\r\n" "\r\n"),
+                         etag   = document->find("\r\n" "ETag: ");
+            if (match == string::npos or etag == string::npos or etag > body)
+              return nullptr;
+            const string tag = document->substr(etag + 8, document->find("\r\n", etag + 8) - etag - 8),
+                         tags = in.substr(match + 17, in.find("\r\n", match + 17) - match - 17);
+            if (tags.find(tag) == string::npos and tags != "*")
+              return nullptr;
+            return make_shared<const string>(
+              "HTTP/1.1 304 Not Modified" + document->substr(status, body + 4 - status)
+            );
+          };
           string address() const {
             string addr;
 #ifndef _WIN32
@@ -906,27 +1084,60 @@ namespace ₿ {
 #endif
             return addr.empty() ? "unknown" : addr;
           };
+          bool writing() const {
+            return !out.empty();
+          };
+          void push(const shared_ptr<const string> &data, const bool &broadcasted = false) {
+            out.emplace_back(data, broadcasted);
+            queued += data->length();
+            if (broadcasted) backlog += data->length();
+          };
+          void flush() {
+            for (const auto &it : latest)
+              push(it.second, true);
+            latest.clear();
+            change(EPOLLIN | EPOLLOUT);
+          };
+          const string &buffer() const {
+            return *out.front().first;
+          };
+          void wrote(const size_t &n) {
+            sent += n;
+            if ((written += n) < buffer().length()) return;
+            queued -= buffer().length();
+            if (out.front().second) backlog -= buffer().length();
+            out.pop_front();
+            if (queued <= budget and !latest.empty())
+              flush();
+            written = 0;
+          };
           void io() {
             if (ssl) {
-              if (!out.empty()) {
+              if (writing()) {
                 cork(1);
-                int n = SSL_write(ssl, out.data(), (int)out.length());
-                switch (SSL_get_error(ssl, n)) {
-                  case SSL_ERROR_WANT_READ:
-                  case SSL_ERROR_WANT_WRITE:  break;
-                  case SSL_ERROR_NONE:        out.clear();
-                                              change(EPOLLIN);  [[fallthrough]];
-                  case SSL_ERROR_ZERO_RETURN: if (!time) break; [[fallthrough]];
-                  default:                    shutdown();
-                                              return;
+                for (int n = 1; n > 0 and writing();) {
+                  n = SSL_write(ssl, buffer().data() + written, (int)(buffer().length() - written));
+                  switch (SSL_get_error(ssl, n)) {
+                    case SSL_ERROR_WANT_READ:
+                    case SSL_ERROR_WANT_WRITE:  n = 0;
+                                                break;
+                    case SSL_ERROR_NONE:        wrote(n);
+                                                if (writing()) break;
+                                                change(EPOLLIN);  [[fallthrough]];
+                    case SSL_ERROR_ZERO_RETURN: if (!time) break; [[fallthrough]];
+                    default:                    shutdown();
+                                                return;
+                  }
                 }
                 cork(0);
               }
-              do {
-                char data[1024];
-                int n = SSL_read(ssl, data, sizeof(data));
+              for (int n = 0; !n or n == chunk or SSL_pending(ssl);) {
+                const size_t len = in.length();
+                in.resize(len + chunk);
+                n = SSL_read(ssl, &in[len], chunk);
+                in.resize(len + max(0, n));
                 switch (SSL_get_error(ssl, n)) {
-                  case SSL_ERROR_NONE:        in.append(data, n);
+                  case SSL_ERROR_NONE:        continue;
                   case SSL_ERROR_WANT_READ:
                   case SSL_ERROR_WANT_WRITE:
                   case SSL_ERROR_ZERO_RETURN: break;
@@ -934,18 +1145,21 @@ namespace ₿ {
                                               shutdown();
                                               return;
                 }
-              } while (SSL_pending(ssl));
+                break;
+              }
             } else {
-              if (!out.empty()) {
+              if (writing()) {
                 cork(1);
-                ssize_t n = ::send(sockfd, out.data(), out.length(), MSG_NOSIGNAL);
-                if      (n > 0) out = out.substr(n);
-                else if (n < 0) {
-                  shutdown();
-                  return;
+                for (ssize_t n = 1; n > 0 and writing();) {
+                  n = ::send(sockfd, buffer().data() + written, buffer().length() - written, MSG_NOSIGNAL);
+                  if      (n > 0) wrote(n);
+                  else if (n < 0 and errno != EAGAIN and errno != EWOULDBLOCK) {
+                    shutdown();
+                    return;
+                  }
                 }
                 cork(0);
-                if (out.empty()) {
+                if (!writing()) {
                   if (time) {
                     shutdown();
                     return;
@@ -953,9 +1167,12 @@ namespace ₿ {
                   change(EPOLLIN);
                 }
               }
-              char data[1024];
-              ssize_t n = ::recv(sockfd, data, sizeof(data), 0);
-              if (n > 0) in.append(data, n);
+              for (ssize_t n = chunk; n == chunk;) {
+                const size_t len = in.length();
+                in.resize(len + chunk);
+                n = ::recv(sockfd, &in[len], chunk, MSG_DONTWAIT);
+                in.resize(len + max((ssize_t)0, n));
+              }
             }
           };
       };
@@ -966,6 +1183,7 @@ namespace ₿ {
                  SSL_CTX *ctx = nullptr;
                  Session  session;
           list<Frontend>  requests;
+           unsigned long  accepted = 0;
         public:
           bool idle() const {
             return !any_of(requests.begin(), requests.end(), [](auto &it) {
@@ -981,12 +1199,43 @@ namespace ₿ {
             return "HTTP" + string(ctx ? 1 : 0, 'S');
           };
           void broadcast(const char &portal, const unordered_map<char, string> &queue) {
-            string msgs;
-            for (const auto &it : queue)
-              msgs += frame(portal + (it.first + it.second), 0x01, false);
+            string frames,
+                   deflated;
+            bool zlib = false,
+                 lag  = false;
+            for (const auto &it : requests)
+              if (it.upgraded()) {
+                zlib |= it.deflated();
+                lag  |= it.lagging();
+              }
+            unordered_map<char, pair<shared_ptr<const string>, shared_ptr<const string>>> topics;
+            for (const auto &it : queue) {
+              const string msg   = portal + (it.first + it.second),
+                           plain = frame(msg, 0x01, false),
+                           zip   = zlib ? frame_deflate(msg, session.deflate) : "";
+              frames   += plain;
+              deflated += zip;
+              if (lag) topics[it.first] = {
+                make_shared<const string>(plain),
+                make_shared<const string>(zip)
+              };
+            }
+            const auto msgs = make_shared<const string>(move(frames)),
+                       zmsgs = make_shared<const string>(move(deflated));
             for (auto &it : requests)
-              if (it.upgraded())
-                it.send(msgs);
+              if (!it.upgraded()) continue;
+              else if (it.lagging())
+                for (const auto &topic : topics)
+                  it.conflate(topic.first, it.deflated() ? topic.second.second : topic.second.first);
+              else it.send(it.deflated() ? zmsgs : msgs, true);
+          };
+          //! \brief Reply later to a client, if it is still connected.
+          void reply(const unsigned long &client, const string &msg) {
+            for (auto &it : requests)
+              if (it.is(client)) {
+                if (it.upgraded()) it.reply(msg);
+                break;
+              }
           };
           void purge() {
             if (!requests.empty()) {
@@ -1095,13 +1344,24 @@ namespace ₿ {
             }
             return warn;
           };
-          string document(const string &content, const unsigned int &code, const string &type) const {
+          //! \brief     Full HTTP response of a document.
+          //! \param[in] etag      Content hash, to reply 304 on a matching If-None-Match.
+          //! \param[in] immutable Allows browsers to cache it forever (for hashed paths).
+          string document(
+            const string       &content,
+            const unsigned int &code,
+            const string       &type,
+            const string       &etag      = "",
+            const bool         &immutable = false
+          ) const {
             string headers;
             if      (code == 200) headers = "HTTP/1.1 200 OK"
                                             "\r\n" "Connection: keep-alive"
                                             "\r\n" "Accept-Ranges: bytes"
                                             "\r\n" "Vary: Accept-Encoding"
-                                            "\r\n" "Cache-Control: public, max-age=0";
+                                            "\r\n" "Cache-Control: public, "
+                                          + string(immutable ? "max-age=31536000, immutable" : "max-age=0")
+                                          + (etag.empty() ? "" : "\r\n" "ETag: \"" + etag + '"');
             else if (code == 401) headers = "HTTP/1.1 401 Unauthorized"
                                             "\r\n" "Connection: keep-alive"
                                             "\r\n" "Accept-Ranges: bytes"
@@ -1138,9 +1398,11 @@ namespace ₿ {
                 ssl = SSL_new(ctx);
                 SSL_set_accept_state(ssl);
                 SSL_set_fd(ssl, clientfd);
-                SSL_set_mode(ssl, SSL_MODE_RELEASE_BUFFERS);
+                SSL_set_mode(ssl, SSL_MODE_RELEASE_BUFFERS
+                                | SSL_MODE_ENABLE_PARTIAL_WRITE
+                                | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
               }
-              requests.emplace_back(clientfd, loopfd, ssl, &session);
+              requests.emplace_back(clientfd, loopfd, ssl, &session, ++accepted);
             }
             return clientfd > 0;
           };
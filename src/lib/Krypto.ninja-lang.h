@@ -10,14 +10,18 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <array>
 #include <unordered_map>
 #include <map>
 #include <list>
+#include <deque>
 #include <ctime>
 #include <cmath>
 #include <mutex>
+#include <condition_variable>
 #include <thread>
 #include <future>
+#include <atomic>
 #include <chrono>
 #include <random>
 #include <locale>
@@ -34,6 +38,8 @@
 #include <execinfo.h>
 #include <sys/socket.h>
 #include <sys/resource.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
@@ -51,6 +57,8 @@
 #include <sys/eventfd.h>
 #endif
 
+#include <zlib.h>
+
 #include <json.h>
 
 #include <sqlite3.h>
@@ -106,6 +114,10 @@ using Clock  = long long int;
 #define accept4(a, b, c, d) accept(a, b, c)
 #endif
 
+#ifndef MSG_DONTWAIT
+#define MSG_DONTWAIT        0
+#endif
+
 //! \def
 //! \brief Redundant placeholder to enforce private references.
 #define private_ref private
@@ -401,7 +401,12 @@ namespace ₿ {
       };
       mOrder *upsert(const mOrder &raw) {
         mOrder *const order = findsert(raw);
+        const bool sent = order
+          and order->status == Status::Waiting
+          and order->exchangeId.empty();
         mOrder::update(raw, order);
+        if (sent and order->status == Status::Working)
+          Metrics::acked.observe(order->latency);
         if (K.arg<int>("debug-orders")) {
           report(order, " saved ");
           report_size();
@@ -441,6 +446,29 @@ namespace ₿ {
         broadcast();
         Print::repaint();
       };
+      json snapshot() const {
+        return working();
+      };
+      void restore(const json &j) {
+        for (const json &it : j) {
+          mOrder order;
+          order.orderId         = it.value("orderId",         "");
+          order.exchangeId      = it.value("exchangeId",      "");
+          order.side            = it.value("side",            Side::Bid);
+          order.price           = it.value("price",           0.0);
+          order.quantity        = it.value("quantity",        0.0);
+          order.type            = it.value("type",            OrderType::Limit);
+          order.timeInForce     = it.value("timeInForce",     TimeInForce::GTC);
+          order.status          = it.value("status",          Status::Terminated);
+          order.isPong          = it.value("isPong",          false);
+          order.disablePostOnly = it.value("disablePostOnly", false);
+          order.time            = it.value("time",            (Clock)0);
+          order.latency         = it.value("latency",         (Clock)0);
+          if (!order.orderId.empty() and !order.exchangeId.empty()
+            and order.status == Status::Working
+          ) orders[order.orderId] = order;
+        }
+      };
       mMatter about() const override {
         return mMatter::OrderStatusReports;
       };
@@ -469,36 +497,146 @@ namespace ₿ {
     j = k.blob();
   };
 
+  struct mTakersVolume {
+          Amount buySize  = 0,
+                 sellSize = 0;
+           Price value    = 0;
+    unsigned int count    = 0;
+    Price vwap() const {
+      return buySize + sellSize
+        ? value / (buySize + sellSize)
+        : 0;
+    };
+    mTakersVolume &operator+=(const mTrade &trade) {
+      (trade.side == Side::Bid
+        ? sellSize
+        : buySize
+      ) += trade.quantity;
+      value += trade.price * trade.quantity;
+      ++count;
+      return *this;
+    };
+    mTakersVolume &operator+=(const mTakersVolume &volume) {
+      buySize  += volume.buySize;
+      sellSize += volume.sellSize;
+      value    += volume.value;
+      count    += volume.count;
+      return *this;
+    };
+    mTakersVolume &operator-=(const mTakersVolume &volume) {
+      if (!volume.count) return *this;
+      if (count > volume.count) {
+        buySize  -= volume.buySize;
+        sellSize -= volume.sellSize;
+        value    -= volume.value;
+        count    -= volume.count;
+      } else *this = {};
+      return *this;
+    };
+  };
+
   struct mMarketTakers: public Client::Broadcast<mTrade> {
     public:
-      vector<mTrade> trades;
-              Amount takersBuySize60s  = 0,
-                     takersSellSize60s = 0;
+      deque<mTrade> trades;
+             Amount takersBuySize60s  = 0,
+                    takersSellSize60s = 0;
+    private:
+                      array<mTakersVolume, 300> buckets;
+      vector<pair<unsigned int, mTakersVolume>> windows = {
+                                                  {  1, {}},
+                                                  { 10, {}},
+                                                  { 60, {}},
+                                                  {300, {}}
+                                                };
+                                          Clock second = 0;
+    public:
       mMarketTakers(const KryptoNinja &bot)
         : Broadcast(bot)
       {};
       void timer_60s() {
-        takersSellSize60s = takersBuySize60s = 0;
-        for (const auto &it : trades)
-          (it.side == Side::Bid
-            ? takersSellSize60s
-            : takersBuySize60s
-          ) += it.quantity;
-        trades.clear();
+        const mTakersVolume &minute = window(60);
+        takersBuySize60s  = minute.buySize;
+        takersSellSize60s = minute.sellSize;
       };
       void read_from_gw(const mTrade &raw) {
+        advance();
+        buckets[second % buckets.size()] += raw;
+        for (auto &it : windows) it.second += raw;
         trades.push_back(raw);
+        if (trades.size() > buckets.size())
+          trades.pop_front();
         broadcast();
       };
+      //! \brief     Aggregated taker trades of the last seconds.
+      //! \param[in] seconds Length of the window, one of 1, 10, 60 or 300.
+      //! \return    Buy/sell volume, count and VWAP, or empty if unknown window.
+      const mTakersVolume &window(const unsigned int &seconds) {
+        static const mTakersVolume none;
+        advance();
+        for (const auto &it : windows)
+          if (it.first == seconds) return it.second;
+        return none;
+      };
+      json snapshot() const {
+        json volumes = json::array();
+        for (const mTakersVolume &it : buckets)
+          volumes.push_back({it.buySize, it.sellSize, it.value, it.count});
+        return {
+          { "trades", trades },
+          { "second", second },
+          {"buckets", volumes}
+        };
+      };
+      void restore(const json &j) {
+        trades = j.value("trades", deque<mTrade>());
+        second = j.value("second", (Clock)0);
+        const json volumes = j.value("buckets", json::array());
+        for (size_t i = 0; i < buckets.size() and i < volumes.size(); ++i)
+          buckets[i] = {
+            volumes.at(i).at(0).get<Amount>(),
+            volumes.at(i).at(1).get<Amount>(),
+            volumes.at(i).at(2).get<Price>(),
+            volumes.at(i).at(3).get<unsigned int>()
+          };
+        for (auto &it : windows) {
+          it.second = {};
+          for (unsigned int i = 0; i < it.first; ++i)
+            it.second += buckets[(second - i) % buckets.size()];
+        }
+        advance();
+        ++version;
+      };
       mMatter about() const override {
         return mMatter::MarketTrade;
       };
+      bool delta() const override {
+        return true;
+      };
       json blob() const override {
         return trades.back();
       };
       json hello() override {
         return trades;
       };
+    protected:
+      bool cached() const override {
+        return true;
+      };
+    private:
+      void advance() {
+        const Clock now = Tstamp / 1e+3;
+        if (now <= second) return;
+        if (now - second >= (Clock)buckets.size()) {
+          buckets.fill({});
+          for (auto &it : windows) it.second = {};
+          second = now;
+        } else while (second < now) {
+          ++second;
+          for (auto &it : windows)
+            it.second -= buckets[(second - it.first) % buckets.size()];
+          buckets[second % buckets.size()] = {};
+        }
+      };
   };
 
   struct mFairLevelsPrice: public Client::Broadcast<mFairLevelsPrice> {
@@ -521,6 +659,9 @@ namespace ₿ {
       bool read_same_blob() const override {
         return false;
       };
+      size_t hash() const override {
+        return combine(currentPrice());
+      };
       bool read_asap() const override {
         return false;
       };
@@ -583,6 +724,19 @@ namespace ₿ {
       Clock lifetime() const override {
         return 1e+3 * limit();
       };
+      vector<string> columns() const override {
+        return {"fv", "bid", "ask"};
+      };
+      bool journal() const override {
+        return true;
+      };
+      Row row(const json &j) const override {
+        const mStdev k = j;
+        return {k.fv, k.topBid, k.topAsk};
+      };
+      void load(const Row &row, const Clock&) override {
+        rows.push_back({row[0], row[1], row[2]});
+      };
     private:
       double calc(Price *const mean, const string &type) const {
         vector<Price> values;
@@ -644,6 +798,15 @@ namespace ₿ {
       Clock lifetime() const override {
         return 60e+3 * limit();
       };
+      vector<string> columns() const override {
+        return {"fv"};
+      };
+      Row row(const json &j) const override {
+        return {j.get<Price>()};
+      };
+      void load(const Row &row, const Clock&) override {
+        rows.push_back(row[0]);
+      };
     private:
       string explainOK() const override {
         return "loaded % historical Fair Values";
@@ -663,19 +826,32 @@ namespace ₿ {
                  mgEwmaW  = 0;
           double mgEwmaTrendDiff              = 0,
                  targetPositionAutoPercentage = 0;
+    private:
+      Loop::Async *event = nullptr;
+      future<array<Price, 6>> reply;
+      unsigned int reloading = 0,
+                   postponed = 0,
+                   pushed    = 0;
     private_ref:
+      const KryptoNinja    &K;
       const Price          &fairValue;
       const mQuotingParams &qp;
     public:
       mEwma(const KryptoNinja &bot, const Price &f, const mQuotingParams &q)
         : StructBackup(bot)
         , Catch(bot, {
-            {&q, [&]() { calcFromHistory(); }}
+            {&q, [&]() { calcFromHistory(qp._diffEwma); }}
           })
         , fairValue96h(bot)
+        , K(bot)
         , fairValue(f)
         , qp(q)
       {};
+      //! \brief     Allow to reload large histories outside the main thread.
+      //! \param[in] loop Event loop that receives the reloaded values.
+      void waitForHistory(Loop *const loop) {
+        event = loop->async([&]() { waitFor(); });
+      };
       void timer_60s(const Price &averageWidth) {
         prepareHistory();
         calcProtections(averageWidth);
@@ -683,6 +859,21 @@ namespace ₿ {
         calcTargetPositionAutoPercentage();
         backup();
       };
+      json snapshot() const {
+        return {
+          {"values", {mgEwmaVL, mgEwmaL, mgEwmaM, mgEwmaS, mgEwmaXS, mgEwmaU, mgEwmaP, mgEwmaW}},
+          {"trendDiff", mgEwmaTrendDiff             },
+          {   "target", targetPositionAutoPercentage}
+        };
+      };
+      void restore(const json &j) {
+        Price *const mean[8] = {&mgEwmaVL, &mgEwmaL, &mgEwmaM, &mgEwmaS, &mgEwmaXS, &mgEwmaU, &mgEwmaP, &mgEwmaW};
+        const json values = j.value("values", json::array());
+        for (size_t i = 0; i < 8 and i < values.size(); ++i)
+          *mean[i] = values.at(i).get<Price>();
+        mgEwmaTrendDiff              = j.value("trendDiff", 0.0);
+        targetPositionAutoPercentage = j.value("target",    0.0);
+      };
       mMatter about() const override {
         return mMatter::EWMAStats;
       };
@@ -696,13 +887,64 @@ namespace ₿ {
                        )))));
       };
     private:
-      void calcFromHistory() {
-        if ((qp._diffEwma >> 0) & 1) calcFromHistory(&mgEwmaVL, qp.veryLongEwmaPeriods,   "VeryLong");
-        if ((qp._diffEwma >> 1) & 1) calcFromHistory(&mgEwmaL,  qp.longEwmaPeriods,       "Long");
-        if ((qp._diffEwma >> 2) & 1) calcFromHistory(&mgEwmaM,  qp.mediumEwmaPeriods,     "Medium");
-        if ((qp._diffEwma >> 3) & 1) calcFromHistory(&mgEwmaS,  qp.shortEwmaPeriods,      "Short");
-        if ((qp._diffEwma >> 4) & 1) calcFromHistory(&mgEwmaXS, qp.extraShortEwmaPeriods, "ExtraShort");
-        if ((qp._diffEwma >> 5) & 1) calcFromHistory(&mgEwmaU,  qp.ultraShortEwmaPeriods, "UltraShort");
+      void calcFromHistory(const unsigned int &diffEwma) {
+        if (!(diffEwma & 0x3F)) return;
+        if (reply.valid()) {
+          postponed |= diffEwma & 0x3F;
+          return;
+        }
+        reloading = diffEwma & 0x3F;
+        if (!event or fairValue96h.size() < 1440)
+          reloaded(calcFromHistory(fairValue96h.rows, alphas()));
+        else {
+          pushed = 0;
+          reply = K.background<array<Price, 6>>([alpha = alphas(), rows = fairValue96h.rows]() {
+            return calcFromHistory(rows, alpha);
+          }, event);
+        }
+      };
+      void waitFor() {
+        if (!reply.valid()) return;
+        array<Price, 6> means = reply.get();
+        const Price *const end = fairValue96h.rows.data() + fairValue96h.size();
+        calc(&means, end - min((size_t)pushed, fairValue96h.size()), end, alphas());
+        reloaded(means);
+        if (postponed)
+          calcFromHistory(exchange(postponed, 0));
+      };
+      void reloaded(const array<Price, 6> &means) {
+        Price *const mean[6] = {&mgEwmaVL, &mgEwmaL, &mgEwmaM, &mgEwmaS, &mgEwmaXS, &mgEwmaU};
+        const string name[6] = {"VeryLong", "Long", "Medium", "Short", "ExtraShort", "UltraShort"};
+        for (size_t i = 0; i < 6; ++i)
+          if ((reloading >> i) & 1) {
+            *mean[i] = means[i];
+            Print::log("MG", "reloaded " + to_string(*mean[i]) + " EWMA " + name[i]);
+          }
+        reloading = 0;
+      };
+      array<double, 6> alphas() const {
+        return {
+          2.0 / (qp.veryLongEwmaPeriods   + 1),
+          2.0 / (qp.longEwmaPeriods       + 1),
+          2.0 / (qp.mediumEwmaPeriods     + 1),
+          2.0 / (qp.shortEwmaPeriods      + 1),
+          2.0 / (qp.extraShortEwmaPeriods + 1),
+          2.0 / (qp.ultraShortEwmaPeriods + 1)
+        };
+      };
+      static array<Price, 6> calcFromHistory(const vector<Price> &rows, const array<double, 6> &alpha) {
+        array<Price, 6> means = {};
+        if (rows.empty()) return means;
+        means.fill(rows.front());
+        calc(&means, rows.data() + 1, rows.data() + rows.size(), alpha);
+        return means;
+      };
+      static void calc(array<Price, 6> *const means, const Price *it, const Price *const end, const array<double, 6> &alpha) {
+        for (; it < end; ++it)
+          for (size_t i = 0; i < 6; ++i)
+            (*means)[i] = (*means)[i]
+              ? alpha[i] * *it + (1 - alpha[i]) * (*means)[i]
+              : *it;
       };
       void calc(Price *const mean, const unsigned int &periods, const Price &value) {
         if (*mean) {
@@ -712,14 +954,7 @@ namespace ₿ {
       };
       void prepareHistory() {
         fairValue96h.push_back(fairValue);
-      };
-      void calcFromHistory(Price *const mean, const unsigned int &periods, const string &name) {
-        unsigned int n = fairValue96h.size();
-        if (!n--) return;
-        unsigned int x = 0;
-        *mean = fairValue96h.front();
-        while (n--) calc(mean, periods, fairValue96h.at(++x));
-        Print::log("MG", "reloaded " + to_string(*mean) + " EWMA " + name);
+        if (reply.valid()) ++pushed;
       };
       void calcPositions() {
         calc(&mgEwmaVL, qp.veryLongEwmaPeriods,   fairValue);
@@ -940,6 +1175,7 @@ namespace ₿ {
         return !(bids.empty() or asks.empty());
       };
       void read_from_gw(const mLevels &raw) {
+        ++Metrics::levels;
         unfiltered.bids = raw.bids;
         unfiltered.asks = raw.asks;
         filter();
@@ -1067,6 +1303,16 @@ namespace ₿ {
       Clock lifetime() const override {
         return 3600e+3 * limit();
       };
+      vector<string> columns() const override {
+        return {"baseValue", "quoteValue"};
+      };
+      Row row(const json &j) const override {
+        const mProfit k = j;
+        return {k.baseValue, k.quoteValue};
+      };
+      void load(const Row &row, const Clock &time) override {
+        rows.push_back({row[0], row[1], time});
+      };
     private:
       string explainOK() const override {
         return "loaded % historical Profits";
@@ -1259,6 +1505,17 @@ namespace ₿ {
   struct mTradesHistory: public Sqlite::VectorBackup<mOrderFilled>,
                          public Client::Broadcast<mOrderFilled>,
                          public Client::Clicked::Catch {
+    multimap<Price, mOrderFilled> openBids,
+                                  openAsks;
+    private:
+      unordered_map<string, multimap<Price, mOrderFilled>::iterator> opened;
+                 multimap<pair<Clock, Clock>, string> sorted;
+      unordered_map<string, multimap<pair<Clock, Clock>, string>::iterator> indexed;
+                               unordered_map<string, size_t> position;
+                                                      size_t pushed = 0;
+                                                       Clock latest = 0;
+                                                const size_t pageSize  = 100,
+                                                             pageLimit = 1000;
     private_ref:
       const KryptoNinja    &K;
       const mQuotingParams &qp;
@@ -1276,7 +1533,7 @@ namespace ₿ {
       {};
       void insert(const mLastOrder &order) {
         const Amount fee = 0;
-        const Clock time = Tstamp;
+        const Clock time = latest = max((Clock)Tstamp, latest + 1);
         mOrderFilled filled = {
           order.side,
           order.price,
@@ -1301,131 +1558,229 @@ namespace ₿ {
           Price widthPong = qp.widthPercentage
             ? qp.widthPongPercentage * filled.price / 100
             : qp.widthPong;
-          map<Price, string> matches;
-          for (mOrderFilled &it : rows)
-            if (it.quantity - it.Kqty > 0 and it.side != filled.side) {
-              const Price combinedFee = K.gateway->makeFee * (it.price + filled.price);
-              if (filled.side == Side::Bid
-                  ? (it.price > filled.price + widthPong + combinedFee)
-                  : (it.price < filled.price - widthPong - combinedFee)
-              ) matches[it.price] = it.tradeId;
-            }
-          matchPong(
-            matches,
-            filled,
-            (qp.pongAt == mPongAt::LongPingFair or qp.pongAt == mPongAt::LongPingAggressive)
-              ? filled.side == Side::Ask
-              : filled.side == Side::Bid
-          );
+          multimap<Price, mOrderFilled> &pings = filled.side == Side::Bid
+            ? openAsks
+            : openBids;
+          const auto matchable = [&](const Price &price) {
+            const Price combinedFee = K.gateway->makeFee * (price + filled.price);
+            return filled.side == Side::Bid
+              ? (price > filled.price + widthPong + combinedFee)
+              : (price < filled.price - widthPong - combinedFee);
+          };
+          auto from = pings.begin(),
+               to   = pings.end();
+          if (filled.side == Side::Bid) {
+            from = pings.upper_bound(
+              (filled.price * (1 + K.gateway->makeFee) + widthPong) / (1 - K.gateway->makeFee)
+            );
+            while (from != pings.begin() and matchable(prev(from)->first)) --from;
+            while (from != pings.end() and !matchable(from->first)) ++from;
+          } else {
+            to = pings.lower_bound(
+              (filled.price * (1 - K.gateway->makeFee) - widthPong) / (1 + K.gateway->makeFee)
+            );
+            while (to != pings.end() and matchable(to->first)) ++to;
+            while (to != pings.begin() and !matchable(prev(to)->first)) --to;
+          }
+          if ((qp.pongAt == mPongAt::LongPingFair or qp.pongAt == mPongAt::LongPingAggressive)
+            ? filled.side == Side::Ask
+            : filled.side == Side::Bid
+          ) while (from != to) {
+            const auto it = prev(to);
+            const bool last = it == from;
+            if (!matchPong(it->second.tradeId, &filled) or last) break;
+          } else while (from != to)
+            if (!matchPong((from++)->second.tradeId, &filled)) break;
+          matchPong(filled);
         }
         if (qp.cleanPongsAuto)
           clearPongsAuto();
       };
+      //! \brief Rows matched by pongs, or -1 if pongs are not matched.
+      int pongs() const {
+        if (qp.safety != mQuotingSafety::Boomerang and qp.safety != mQuotingSafety::AK47)
+          return -1;
+        return count_if(rows.begin(), rows.end(), [](const mOrderFilled &it) {
+          return it.Kqty > 0;
+        });
+      };
       mMatter about() const override {
         return mMatter::Trades;
       };
+      bool delta() const override {
+        return true;
+      };
+      Report pull(const json &j) override {
+        const Report note = VectorBackup::pull(j);
+        for (size_t n = 0; n < rows.size(); ++n) {
+          position[rows[n].tradeId] = n;
+          reopen(rows[n]);
+          reindex(rows[n]);
+          latest = max(latest, rows[n].time);
+        }
+        ++version;
+        return note;
+      };
       void erase() override {
-        if (crbegin()->Kqty < 0) rows.pop_back();
+        if (rows.at(pushed).Kqty >= 0) return;
+        position.erase(rows[pushed].tradeId);
+        if (pushed != rows.size() - 1) {
+          rows[pushed] = move(rows.back());
+          position[rows[pushed].tradeId] = pushed;
+        }
+        rows.pop_back();
       };
       json blob() const override {
-        if (crbegin()->Kqty == -1) return nullptr;
-        else return VectorBackup::blob();
+        if (rows.at(pushed).Kqty == -1) return nullptr;
+        else return rows.at(pushed);
       };
       string increment() const override {
-        return crbegin()->tradeId;
+        return rows.at(pushed).tradeId;
       };
       json hello() override {
         for (mOrderFilled &it : rows)
           it.loadedFromDB = true;
-        return rows;
+        return latest_rows({numeric_limits<Clock>::max(), numeric_limits<Clock>::max()}, pageSize);
+      };
+      json page(const json &j) override {
+        if (!j.is_object()) return json::array();
+        for (const char *const it : {"until", "time", "limit"})
+          if (j.contains(it) and !j.at(it).is_number())
+            return json::array();
+        return latest_rows(
+          {
+            j.value("until", numeric_limits<Clock>::max()),
+            j.value("time",  numeric_limits<Clock>::max())
+          },
+          min(j.value("limit", pageSize), pageLimit)
+        );
+      };
+    protected:
+      bool cached() const override {
+        return true;
       };
     private:
+      //! \brief     Newest rows sorted by time (or pong time), like the UI does,
+      //!            and then by ping time, that is unique for each row.
+      //! \param[in] until Exclude this row and the newer ones, given as
+      //!                  its time (or pong time) and its ping time.
+      //! \param[in] limit Maximum number of rows.
+      json latest_rows(const pair<Clock, Clock> &until, const size_t &limit) const {
+        json reply = json::array();
+        for (
+          auto it = make_reverse_iterator(sorted.lower_bound(until));
+          it != sorted.rend() and reply.size() < limit;
+          ++it
+        ) reply.push_back(rows[position.at(it->second)]);
+        return reply;
+      };
       void clearAll() {
-        clear_if([](iterator) {
+        clear_if([](const mOrderFilled&) {
           return true;
         });
       };
       void clearOne(const string &tradeId) {
-        clear_if([&tradeId](iterator it) {
-          return it->tradeId == tradeId;
-        }, true);
+        if (position.find(tradeId) == position.end()) return;
+        rows[position.at(tradeId)].Kqty = -1;
+        broadcast_push(position.at(tradeId));
       };
       void clearClosed() {
-        clear_if([](iterator it) {
-          return it->Kqty >= it->quantity;
+        clear_if([](const mOrderFilled &it) {
+          return it.Kqty >= it.quantity;
         });
       };
       void clearPongsAuto() {
         const Clock expire = Tstamp - (abs(qp.cleanPongsAuto) * 86400e3);
         const bool forcedClean = qp.cleanPongsAuto < 0;
-        clear_if([&expire, &forcedClean](iterator it) {
-          return (it->Ktime?:it->time) < expire and (
+        clear_if([&expire, &forcedClean](const mOrderFilled &it) {
+          return (it.Ktime?:it.time) < expire and (
             forcedClean
-            or it->Kqty >= it->quantity
+            or it.Kqty >= it.quantity
           );
         });
       };
-      void clear_if(const function<bool(iterator)> &fn, const bool &onlyOne = false) {
-        for (auto it = begin(); it != end();)
-          if (fn(it)) {
-            it->Kqty = -1;
-            it = send_push_erase(it);
-            if (onlyOne) break;
-          } else ++it;
-      };
-      void matchPong(const map<Price, string> &matches, mOrderFilled pong, const bool &reverse) {
-        if (reverse) for (auto it = matches.crbegin(); it != matches.crend(); ++it) {
-          if (!matchPong(it->second, &pong)) break;
-        } else for (const auto &it : matches)
-          if (!matchPong(it.second, &pong)) break;
-        if (pong.quantity > 0) {
-          bool eq = false;
-          for (auto it = begin(); it != end(); ++it) {
-            if (it->price!=pong.price or it->side!=pong.side or it->quantity<=it->Kqty) continue;
-            eq = true;
-            it->time = pong.time;
-            it->quantity = it->quantity + pong.quantity;
-            it->value = it->value + pong.value;
-            it->isPong = false;
-            it->loadedFromDB = false;
-            it = send_push_erase(it);
-            break;
+      void clear_if(const function<bool(const mOrderFilled&)> &fn) {
+        for (size_t n = rows.size(); n--;)
+          if (fn(rows[n])) {
+            rows[n].Kqty = -1;
+            broadcast_push(n);
           }
-          if (!eq) broadcast_push_back(pong);
+      };
+      void matchPong(const mOrderFilled &pong) {
+        if (pong.quantity <= 0) return;
+        multimap<Price, mOrderFilled> &pings = pong.side == Side::Bid
+          ? openBids
+          : openAsks;
+        const auto it = pings.find(pong.price);
+        if (it == pings.end())
+          broadcast_push_back(pong);
+        else {
+          const size_t n = position.at(it->second.tradeId);
+          rows[n].time = pong.time;
+          rows[n].quantity = rows[n].quantity + pong.quantity;
+          rows[n].value = rows[n].value + pong.value;
+          rows[n].isPong = false;
+          rows[n].loadedFromDB = false;
+          broadcast_push(n);
         }
       };
       bool matchPong(const string &match, mOrderFilled *const pong) {
-        for (auto it = begin(); it != end(); ++it) {
-          if (it->tradeId != match) continue;
-          Amount Kqty = fmin(pong->quantity, it->quantity - it->Kqty);
-          it->Ktime = pong->time;
-          it->Kprice = ((Kqty*pong->price) + (it->Kqty*it->Kprice)) / (it->Kqty+Kqty);
-          it->Kqty = it->Kqty + Kqty;
-          it->Kvalue = abs(it->Kqty*it->Kprice);
-          pong->quantity = pong->quantity - Kqty;
-          pong->value = abs(pong->price*pong->quantity);
-          if (it->quantity <= it->Kqty)
-            it->Kdiff = ((it->quantity * it->price) - (it->Kqty * it->Kprice))
-                      * (it->side == Side::Ask ? 1 : -1);
-          it->isPong = true;
-          it->loadedFromDB = false;
-          it = send_push_erase(it);
-          break;
-        }
+        const size_t n = position.at(match);
+        mOrderFilled &it = rows[n];
+        Amount Kqty = fmin(pong->quantity, it.quantity - it.Kqty);
+        it.Ktime = pong->time;
+        it.Kprice = ((Kqty*pong->price) + (it.Kqty*it.Kprice)) / (it.Kqty+Kqty);
+        it.Kqty = it.Kqty + Kqty;
+        it.Kvalue = abs(it.Kqty*it.Kprice);
+        pong->quantity = pong->quantity - Kqty;
+        pong->value = abs(pong->price*pong->quantity);
+        if (it.quantity <= it.Kqty)
+          it.Kdiff = ((it.quantity * it.price) - (it.Kqty * it.Kprice))
+                   * (it.side == Side::Ask ? 1 : -1);
+        it.isPong = true;
+        it.loadedFromDB = false;
+        broadcast_push(n);
         return pong->quantity > 0;
       };
       void broadcast_push_back(const mOrderFilled &row) {
+        position[row.tradeId] = rows.size();
         rows.push_back(row);
+        broadcast_push(rows.size() - 1);
+      };
+      void broadcast_push(const size_t &n) {
+        reopen(rows[pushed = n]);
+        reindex(rows[n]);
         backup();
-        if (crbegin()->Kqty < 0) rbegin()->Kqty = -2;
+        if (rows[n].Kqty < 0) rows[n].Kqty = -2;
         broadcast();
-      };
-      iterator send_push_erase(iterator it) {
-        mOrderFilled row = *it;
-        it = rows.erase(it);
-        broadcast_push_back(row);
         erase();
-        return it;
+      };
+      void reopen(const mOrderFilled &row) {
+        auto it = opened.find(row.tradeId);
+        if (it != opened.end()) {
+          (it->second->second.side == Side::Bid
+            ? openBids
+            : openAsks
+          ).erase(it->second);
+          opened.erase(it);
+        }
+        if (row.Kqty >= 0 and row.Kqty < row.quantity)
+          opened[row.tradeId] = (row.side == Side::Bid
+            ? openBids
+            : openAsks
+          ).insert(pair<Price, mOrderFilled>(row.price, row));
+      };
+      void reindex(const mOrderFilled &row) {
+        auto it = indexed.find(row.tradeId);
+        if (it != indexed.end()) {
+          sorted.erase(it->second);
+          indexed.erase(it);
+        }
+        if (row.Kqty >= 0)
+          indexed[row.tradeId] = sorted.insert(pair<pair<Clock, Clock>, string>(
+            make_pair(row.Ktime ?: row.time, row.time),
+            row.tradeId
+          ));
       };
       string explainOK() const override {
         return "loaded % historical Trades";
@@ -1442,6 +1797,43 @@ namespace ₿ {
       , time(Tstamp)
     {};
   };
+  struct mRecentTradesSide {
+    list<mRecentTrade> arrival;
+    multimap<Price, list<mRecentTrade>::iterator> index;
+    Amount sum = 0;
+    bool empty() const {
+      return arrival.empty();
+    };
+    size_t size() const {
+      return arrival.size();
+    };
+    void insert(const mRecentTrade &trade) {
+      index.insert(pair<Price, list<mRecentTrade>::iterator>(
+        trade.price,
+        arrival.insert(arrival.end(), trade)
+      ));
+      sum += trade.quantity;
+    };
+    void expire(const Clock &expire) {
+      while (!arrival.empty() and arrival.front().time <= expire) {
+        auto it = index.equal_range(arrival.front().price).first;
+        while (it->second != arrival.begin()) ++it;
+        erase(it);
+      }
+    };
+    void reduce(const multimap<Price, list<mRecentTrade>::iterator>::iterator &it, const Amount &qty) {
+      it->second->quantity -= qty;
+      sum -= qty;
+      if (it->second->quantity <= 0)
+        erase(it);
+    };
+    void erase(const multimap<Price, list<mRecentTrade>::iterator>::iterator &it) {
+      sum -= it->second->quantity;
+      arrival.erase(it->second);
+      index.erase(it);
+      if (arrival.empty()) sum = 0;
+    };
+  };
   struct mRecentTrades {
     private_ref:
       const mQuotingParams &qp;
@@ -1449,12 +1841,12 @@ namespace ₿ {
       mRecentTrades(const mQuotingParams &q)
         : qp(q)
       {};
-    multimap<Price, mRecentTrade> buys,
-                                  sells;
-                           Amount sumBuys       = 0,
-                                  sumSells      = 0;
-                            Price lastBuyPrice  = 0,
-                                  lastSellPrice = 0;
+    mRecentTradesSide buys,
+                      sells;
+               Amount sumBuys       = 0,
+                      sumSells      = 0;
+                Price lastBuyPrice  = 0,
+                      lastSellPrice = 0;
     void insert(const mLastOrder &order) {
       (order.side == Side::Bid
         ? lastBuyPrice
@@ -1463,43 +1855,51 @@ namespace ₿ {
       (order.side == Side::Bid
         ? buys
         : sells
-      ).insert(pair<Price, mRecentTrade>(
-        order.price,
-        mRecentTrade(order.price, order.tradeQuantity)
-      ));
+      ).insert(mRecentTrade(order.price, order.tradeQuantity));
     };
     void expire() {
-      if (!buys.empty()) expire(&buys);
-      if (!sells.empty()) expire(&sells);
+      const Clock expire = Tstamp - qp.tradeRateSeconds * 1e+3;
+      buys.expire(expire);
+      sells.expire(expire);
       skip();
-      sumBuys = sum(&buys);
-      sumSells = sum(&sells);
+      sumBuys = buys.sum;
+      sumSells = sells.sum;
+    };
+    json snapshot() const {
+      json j = {
+        { "lastBuyPrice", lastBuyPrice },
+        {"lastSellPrice", lastSellPrice},
+        {         "buys", json::array()},
+        {        "sells", json::array()}
+      };
+      for (const mRecentTrade &it : buys.arrival)
+        j["buys"].push_back({it.price, it.quantity, it.time});
+      for (const mRecentTrade &it : sells.arrival)
+        j["sells"].push_back({it.price, it.quantity, it.time});
+      return j;
+    };
+    void restore(const json &j) {
+      lastBuyPrice  = j.value("lastBuyPrice",  0.0);
+      lastSellPrice = j.value("lastSellPrice", 0.0);
+      for (const auto &side : {
+        make_pair("buys",  &buys),
+        make_pair("sells", &sells)
+      }) for (const json &it : j.value(side.first, json::array())) {
+        mRecentTrade trade(it.at(0).get<Price>(), it.at(1).get<Amount>());
+        trade.time = it.at(2).get<Clock>();
+        side.second->insert(trade);
+      }
+      expire();
     };
     private:
-      Amount sum(multimap<Price, mRecentTrade> *const k) const {
-        Amount sum = 0;
-        for (const auto &it : *k)
-          sum += it.second.quantity;
-        return sum;
-      };
-      void expire(multimap<Price, mRecentTrade> *const k) {
-        Clock now = Tstamp;
-        for (auto it = k->begin(); it != k->end();)
-          if (it->second.time + qp.tradeRateSeconds * 1e+3 > now) ++it;
-          else it = k->erase(it);
-      };
       void skip() {
         while (!(buys.empty() or sells.empty())) {
-          mRecentTrade &buy = buys.rbegin()->second;
-          mRecentTrade &sell = sells.begin()->second;
-          if (sell.price < buy.price) break;
-          const Amount buyQty = buy.quantity;
-          buy.quantity -= sell.quantity;
-          sell.quantity -= buyQty;
-          if (buy.quantity <= 0)
-            buys.erase(buys.rbegin()->first);
-          if (sell.quantity <= 0)
-            sells.erase(sells.begin()->first);
+          auto buy = prev(buys.index.end());
+          auto sell = sells.index.begin();
+          if (sell->first < buy->first) break;
+          const Amount qty = fmin(buy->second->quantity, sell->second->quantity);
+          buys.reduce(buy, qty);
+          sells.reduce(sell, qty);
         }
       };
   };
@@ -1553,12 +1953,34 @@ namespace ₿ {
       bool empty() const {
         return !base.value or !buySize or !sellSize;
       };
+      json snapshot() const {
+        return {
+          {      "values", {buy, sell, combined, buyPing, sellPing, buySize, sellSize}},
+          {"recentTrades", recentTrades.snapshot()                                  }
+        };
+      };
+      void restore(const json &j) {
+        const json values = j.value("values", json::array());
+        if (values.size() == 7) {
+          buy      = values.at(0).get<double>();
+          sell     = values.at(1).get<double>();
+          combined = values.at(2).get<double>();
+          buyPing  = values.at(3).get<Price>();
+          sellPing = values.at(4).get<Price>();
+          buySize  = values.at(5).get<Amount>();
+          sellSize = values.at(6).get<Amount>();
+        }
+        recentTrades.restore(j.value("recentTrades", json::object()));
+      };
       mMatter about() const override {
         return mMatter::TradeSafetyValue;
       };
       bool read_same_blob() const override {
         return false;
       };
+      size_t hash() const override {
+        return combine(buy, sell, combined, buyPing, sellPing);
+      };
     private:
       void calcSizes() {
         if (qp.percentageValues) {
@@ -1622,42 +2044,40 @@ namespace ₿ {
             if (recentTrades.lastSellPrice and fairValue < recentTrades.lastSellPrice + widthPong)
               sellPing = recentTrades.lastSellPrice;
           } else {
-            map<Price, mOrderFilled> tradesBuy;
-            map<Price, mOrderFilled> tradesSell;
-            for (const mOrderFilled &it: trades)
-              (it.side == Side::Bid ? tradesBuy : tradesSell)[it.price] = it;
+            const multimap<Price, mOrderFilled> *const tradesBuy  = &trades.openBids,
+                                                *const tradesSell = &trades.openAsks;
             Amount buyQty = 0,
                    sellQty = 0;
             if (qp.pongAt == mPongAt::ShortPingFair or qp.pongAt == mPongAt::ShortPingAggressive) {
-              matchBestPing(&tradesBuy, &buyPing, &buyQty, sellSize, widthPong, true);
-              matchBestPing(&tradesSell, &sellPing, &sellQty, buySize, widthPong);
-              if (!buyQty) matchFirstPing(&tradesBuy, &buyPing, &buyQty, sellSize, widthPong*-1, true);
-              if (!sellQty) matchFirstPing(&tradesSell, &sellPing, &sellQty, buySize, widthPong*-1);
+              matchBestPing(tradesBuy, &buyPing, &buyQty, sellSize, widthPong, true);
+              matchBestPing(tradesSell, &sellPing, &sellQty, buySize, widthPong);
+              if (!buyQty) matchFirstPing(tradesBuy, &buyPing, &buyQty, sellSize, widthPong*-1, true);
+              if (!sellQty) matchFirstPing(tradesSell, &sellPing, &sellQty, buySize, widthPong*-1);
             } else if (qp.pongAt == mPongAt::LongPingFair or qp.pongAt == mPongAt::LongPingAggressive) {
-              matchLastPing(&tradesBuy, &buyPing, &buyQty, sellSize, widthPong);
-              matchLastPing(&tradesSell, &sellPing, &sellQty, buySize, widthPong, true);
+              matchLastPing(tradesBuy, &buyPing, &buyQty, sellSize, widthPong);
+              matchLastPing(tradesSell, &sellPing, &sellQty, buySize, widthPong, true);
             } else if (qp.pongAt == mPongAt::AveragePingFair or qp.pongAt == mPongAt::AveragePingAggressive) {
-              matchAllPing(&tradesBuy, &buyPing, &buyQty, sellSize, widthPong);
-              matchAllPing(&tradesSell, &sellPing, &sellQty, buySize, widthPong);
+              matchAllPing(tradesBuy, &buyPing, &buyQty, sellSize, widthPong);
+              matchAllPing(tradesSell, &sellPing, &sellQty, buySize, widthPong);
             }
             if (buyQty) buyPing /= buyQty;
             if (sellQty) sellPing /= sellQty;
           }
         }
       };
-      void matchFirstPing(map<Price, mOrderFilled> *tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
+      void matchFirstPing(const multimap<Price, mOrderFilled> *const tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
         matchPing(true, true, tradesSide, ping, qty, qtyMax, width, reverse);
       };
-      void matchBestPing(map<Price, mOrderFilled> *tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
+      void matchBestPing(const multimap<Price, mOrderFilled> *const tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
         matchPing(true, false, tradesSide, ping, qty, qtyMax, width, reverse);
       };
-      void matchLastPing(map<Price, mOrderFilled> *tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
+      void matchLastPing(const multimap<Price, mOrderFilled> *const tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
         matchPing(false, true, tradesSide, ping, qty, qtyMax, width, reverse);
       };
-      void matchAllPing(map<Price, mOrderFilled> *tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width) {
+      void matchAllPing(const multimap<Price, mOrderFilled> *const tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width) {
         matchPing(false, false, tradesSide, ping, qty, qtyMax, width);
       };
-      void matchPing(bool _near, bool _far, map<Price, mOrderFilled> *tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
+      void matchPing(bool _near, bool _far, const multimap<Price, mOrderFilled> *const tradesSide, Price *ping, Amount *qty, Amount qtyMax, Price width, bool reverse = false) {
         int dir = width > 0 ? 1 : -1;
         if (reverse) for (auto it = tradesSide->crbegin(); it != tradesSide->crend(); ++it) {
           if (matchPing(_near, _far, ping, qty, qtyMax, width, dir * fairValue, dir * it->second.price, it->second.quantity, it->second.price, it->second.Kqty, reverse))
@@ -1758,6 +2178,9 @@ namespace ₿ {
       bool read_same_blob() const override {
         return false;
       };
+      size_t hash() const override {
+        return combine(targetBasePosition, positionDivergence);
+      };
     private:
       void calcPDiv() {
         Amount pDiv = qp.percentageValues
@@ -1858,6 +2281,12 @@ namespace ₿ {
       bool read_same_blob() const override {
         return false;
       };
+      size_t hash() const override {
+        return combine(
+          base.amount,  base.held,  base.value,  base.profit,
+          quote.amount, quote.held, quote.value, quote.profit
+        );
+      };
     private:
       void calcFundsSilently() {
         if (base.currency.empty() or quote.currency.empty() or !fairValue) return;
@@ -2208,6 +2637,7 @@ namespace ₿ {
         states(mQuoteState::DisabledQuotes);
       };
       void calcQuotes() {
+        ++Metrics::quotes;
         states(mQuoteState::UnknownHeld);
         dummyMM.calcRawQuotes();
         applyQuotingParameters();
@@ -2639,14 +3069,19 @@ namespace ₿ {
       };
       void placeOrder(const mOrder &raw) {
         K.gateway->place(orders.upsert(raw));
+        ++Metrics::placed;
       };
       void replaceOrder(const Price &price, const bool &isPong, mOrder *const order) {
-        if (orders.replace(price, isPong, order))
+        if (orders.replace(price, isPong, order)) {
           K.gateway->replace(order);
+          ++Metrics::replaced;
+        }
       };
       void cancelOrder(mOrder *const order) {
-        if (orders.cancel(order))
+        if (orders.cancel(order)) {
           K.gateway->cancel(order);
+          ++Metrics::cancelled;
+        }
       };
       void cancelOrders() {
         for (mOrder *const it : orders.working())
@@ -2693,18 +3128,37 @@ namespace ₿ {
     public:
       unsigned int orders_60s = 0;
     private:
-      mProduct product;
+                              mProduct product;
+                          Loop::Async *event = nullptr;
+      future<pair<unsigned int, unsigned int>> reply;
+                          unsigned int memory = 0,
+                                       dbsize = 0;
     private_ref:
-      const KryptoNinja &K;
+      const KryptoNinja    &K;
+      const mTradesHistory &trades;
     public:
-      mMemory(const KryptoNinja &bot)
+      mMemory(const KryptoNinja &bot, const mTradesHistory &t)
         : Broadcast(bot)
         , product(bot)
         , K(bot)
+        , trades(t)
       {};
+      //! \brief     Allow to measure usage outside the main thread.
+      //! \param[in] loop Event loop that receives the measured usage.
+      void waitForData(Loop *const loop) {
+        event = loop->async([&]() { waitFor(); });
+        memory = K.memSize();
+        dbsize = K.dbSize();
+      };
       void timer_60s() {
-        broadcast();
-        orders_60s = 0;
+        if (!event) {
+          memory = K.memSize();
+          dbsize = K.dbSize();
+          measured();
+        } else if (!reply.valid())
+          reply = K.background<pair<unsigned int, unsigned int>>([&]() {
+            return make_pair(K.memSize(), K.dbSize());
+          }, event);
       };
       json to_json() const {
         return {
@@ -2712,17 +3166,164 @@ namespace ₿ {
           {  "freq", orders_60s                  },
           { "theme", K.arg<int>("ignore-moon")
                        + K.arg<int>("ignore-sun")},
-          {"memory", K.memSize()                 },
-          {"dbsize", K.dbSize()                  }
+          {"memory", memory                      },
+          {"dbsize", dbsize                      },
+          {"dbmaint", K.maintenance().first      },
+          {"dbfreed", K.maintenance().second     },
+          {"trades", trades.size()               },
+          { "pongs", trades.pongs()              }
         };
       };
       mMatter about() const override {
         return mMatter::ApplicationState;
       };
+    private:
+      void waitFor() {
+        if (!reply.valid()) return;
+        tie(memory, dbsize) = reply.get();
+        measured();
+      };
+      void measured() {
+        broadcast();
+        orders_60s = 0;
+      };
   };
   static void to_json(json &j, const mMemory &k) {
     j = k.to_json();
   };
+
+  class mSnapshot {
+    private:
+      const unsigned int version = 2;
+      const Clock        maxAge  = 300e+3;
+    private_ref:
+      const KryptoNinja &K;
+      mOrders           &orders;
+      mMarketLevels     &levels;
+      mWalletPosition   &wallet;
+    public:
+      mSnapshot(const KryptoNinja &bot, mOrders &o, mMarketLevels &l, mWalletPosition &w)
+        : K(bot)
+        , orders(o)
+        , levels(l)
+        , wallet(w)
+      {};
+      //! \brief     Restore the warm state saved by a previous run, if recent.
+      //! \note      Call it before the gateway connects; nothing is broadcast
+      //!            and no book is restored, so the first fresh book quotes.
+      void load() {
+        if (file().empty()) return;
+        ifstream in(file(), ios::binary);
+        if (!in) return;
+        const string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        const json j = json::from_msgpack(bytes, true, false);
+        try {
+          restore(j);
+        } catch (const exception &e) {
+          Print::logWar("DB", "Ignored malformed snapshot " + file() + " (" + e.what() + ")");
+        }
+      };
+      //! \brief     Save the warm state, replacing the file atomically.
+      //! \note      Only the buffer is built here, the file is written
+      //!            and synced to disk by the DB thread.
+      void save() const {
+        if (file().empty() or wallet.base.currency.empty()) return;
+        json j = {
+          {  "version", version                                 },
+          {     "time", Tstamp                                  },
+          { "exchange", K.gateway->exchange                     },
+          { "currency", K.gateway->base + "/" + K.gateway->quote},
+          {   "orders", orders.snapshot()                       },
+          {   "levels", {
+                          levels.fairValue,
+                          levels.averageWidth,
+                          levels.averageCount
+                        }                                       },
+          {     "ewma", levels.stats.ewma.snapshot()            },
+          {   "takers", levels.stats.takerTrades.snapshot()     },
+          {   "safety", wallet.safety.snapshot()                },
+          {   "target", wallet.target                           },
+          {   "wallet", json::object()                          }
+        };
+        for (const auto &side : {
+          make_pair("base",  &wallet.base),
+          make_pair("quote", &wallet.quote)
+        }) j["wallet"][side.first] = {
+          {"currency", side.second->currency},
+          {  "amount", side.second->amount  },
+          {    "held", side.second->held    },
+          {   "total", side.second->total   },
+          {   "value", side.second->value   },
+          {  "profit", side.second->profit  }
+        };
+        K.background([file = file(), bytes = json::to_msgpack(j)]() {
+          const string tmp = file + ".tmp";
+          FILE *out = fopen(tmp.data(), "wb");
+          if (!out) {
+            Print::logWar("DB", "Unable to save snapshot " + tmp + ", " + strerror(errno));
+            return;
+          }
+          bool ok = fwrite(bytes.data(), 1, bytes.size(), out) == bytes.size()
+                and !fflush(out);
+#ifndef _WIN32
+          ok = ok and !fsync(fileno(out));
+#endif
+          if (!fclose(out) and ok)
+            rename(tmp.data(), file.data());
+          else Print::logWar("DB", "Unable to save snapshot " + file);
+        });
+      };
+    private:
+      void restore(const json &j) {
+        if (!j.is_object()
+          or j.value("version", 0U) != version
+          or j.value("exchange", "") != K.gateway->exchange
+          or j.value("currency", "") != K.gateway->base + "/" + K.gateway->quote
+        ) {
+          Print::logWar("DB", "Ignored incompatible snapshot " + file());
+          return;
+        }
+        const Clock age = Tstamp - j.value("time", (Clock)0);
+        if (age > maxAge) {
+          Print::logWar("DB", "Ignored snapshot older than " + to_string(maxAge / 1000) + " seconds");
+          return;
+        }
+        const json fair = j.value("levels", json::array());
+        if (fair.size() == 3) {
+          levels.fairValue    = fair.at(0).get<Price>();
+          levels.averageWidth = fair.at(1).get<Price>();
+          levels.averageCount = fair.at(2).get<unsigned int>();
+        }
+        for (const auto &side : {
+          make_pair("base",  &wallet.base),
+          make_pair("quote", &wallet.quote)
+        }) {
+          const json it = j.value("wallet", json::object()).value(side.first, json::object());
+          side.second->currency = it.value("currency", "");
+          side.second->amount   = it.value("amount",   0.0);
+          side.second->held     = it.value("held",     0.0);
+          side.second->total    = it.value("total",    0.0);
+          side.second->value    = it.value("value",    0.0);
+          side.second->profit   = it.value("profit",   0.0);
+        }
+        from_json(j.value("target", json::object()), wallet.target);
+        orders.restore(j.value("orders", json::array()));
+        levels.stats.ewma.restore(j.value("ewma", json::object()));
+        levels.stats.stdev.calc();
+        levels.stats.takerTrades.restore(j.value("takers", json::object()));
+        wallet.safety.restore(j.value("safety", json::object()));
+        Print::log("DB", "loaded snapshot OK from", file()
+          + " (" + to_string(age) + "ms old)");
+      };
+      string file() const {
+        const string database = K.arg<string>("diskdata").empty()
+          ? K.arg<string>("database")
+          : K.arg<string>("diskdata");
+        return database.empty() or database == ":memory:"
+          ? ""
+          : database + ".snapshot";
+      };
+  };
 }
 
 #endif
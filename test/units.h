@@ -105,6 +105,71 @@ namespace ₿ {
         }
       }
     }
+    GIVEN("WebSocketFrames") {
+      class Frames: public WebSocketFrames {
+        public:
+          using WebSocketFrames::frame;
+          using WebSocketFrames::frame_deflate;
+          using WebSocketFrames::unframe;
+      } frames;
+      mLevels levels;
+      for (int i = 0; i < 21; i++) {
+        levels.bids.push_back({1234.56 - i * 0.01, 0.12345678 + i});
+        levels.asks.push_back({1234.57 + i * 0.01, 0.12345679 + i});
+      }
+      const string msg = ((json)levels).dump();
+      string data, pong;
+      size_t offset = 0;
+      bool drop = false;
+      WHEN("smaller than threshold") {
+        REQUIRE_NOTHROW(data = frames.frame_deflate(msg, msg.length() + 1));
+        THEN("not compressed") {
+          REQUIRE(data == frames.frame(msg, 0x01, false));
+        }
+      }
+      WHEN("compressed") {
+        REQUIRE_NOTHROW(data = frames.frame_deflate(msg, 512));
+        THEN("smaller") {
+          REQUIRE(data.length() < msg.length() / 2);
+        }
+        THEN("inflated") {
+          REQUIRE(frames.unframe(data, offset, pong, drop, true) == msg);
+          REQUIRE(offset == data.length());
+          REQUIRE_FALSE(drop);
+        }
+        THEN("dropped if not negotiated") {
+          REQUIRE(frames.unframe(data, offset, pong, drop).empty());
+          REQUIRE(drop);
+        }
+#ifdef CATCH_CONFIG_ENABLE_BENCHMARKING
+        THEN("bench") {
+          WARN("permessage-deflate saves " << msg.length() - data.length() << " of " << msg.length() << " bytes");
+          BENCHMARK("frame") {
+            return frames.frame(msg, 0x01, false);
+          };
+          BENCHMARK("frame_deflate") {
+            return frames.frame_deflate(msg, 512);
+          };
+        }
+#endif
+      }
+    }
+    GIVEN("Metrics::Histogram") {
+      Metrics::Histogram histogram;
+      for (const Clock it : {0, 1, 7, 300, 9000})
+        histogram.observe(it);
+      const string text = histogram.text("k_test_seconds", "Test.");
+      THEN("cumulative buckets in seconds") {
+        REQUIRE(text.find("# TYPE k_test_seconds histogram\n")         != string::npos);
+        REQUIRE(text.find("k_test_seconds_bucket{le=\"0.001\"} 2\n")   != string::npos);
+        REQUIRE(text.find("k_test_seconds_bucket{le=\"0.010\"} 3\n")   != string::npos);
+        REQUIRE(text.find("k_test_seconds_bucket{le=\"0.500\"} 4\n")   != string::npos);
+        REQUIRE(text.find("k_test_seconds_bucket{le=\"5.000\"} 4\n")   != string::npos);
+        REQUIRE(text.find("k_test_seconds_bucket{le=\"+Inf\"} 5\n")    != string::npos);
+        REQUIRE(text.find("k_test_seconds_sum 9.308\n")                != string::npos);
+        REQUIRE(text.find("k_test_seconds_count 5\n")                  != string::npos);
+      }
+    }
   }
 
   class BTCEUR {
@@ -150,7 +215,7 @@ namespace ₿ {
     mMarketLevels BTCEUR::levels(BTCEUR::K, BTCEUR::qp, BTCEUR::orders);
   mWalletPosition BTCEUR::wallet(BTCEUR::K, BTCEUR::qp, BTCEUR::orders, BTCEUR::button, BTCEUR::levels);
           mBroker BTCEUR::broker(BTCEUR::K, BTCEUR::qp, BTCEUR::orders, BTCEUR::button, BTCEUR::levels, BTCEUR::wallet);
-          mMemory BTCEUR::memory(BTCEUR::K);
+          mMemory BTCEUR::memory(BTCEUR::K, BTCEUR::wallet.safety.trades);
 
   SCENARIO_METHOD(BTCEUR, "expected") {
     GIVEN("mMarketLevels") {
@@ -318,7 +383,7 @@ namespace ₿ {
               REQUIRE(wallet.safety.recentTrades.lastSellPrice == 1234.60);
               REQUIRE(wallet.safety.recentTrades.buys.size() == 1);
               REQUIRE_FALSE(wallet.safety.recentTrades.sells.size());
-              REQUIRE(wallet.safety.recentTrades.sumBuys == 0.09876546);
+              REQUIRE(wallet.safety.recentTrades.sumBuys == Approx(0.09876546));
               REQUIRE_FALSE(wallet.safety.recentTrades.sumSells);
             }
             THEN("expired") {
@@ -525,6 +590,30 @@ namespace ₿ {
       }
     }
 
+    GIVEN("mMarketTakers") {
+      REQUIRE_NOTHROW(levels.stats.takerTrades.read = [&]() {
+        INFO("read()");
+      });
+      WHEN("assigned") {
+        for (const mTrade &it : vector<mTrade>({
+          {Side::Bid, 1234.50, 0.5, 0},
+          {Side::Ask, 1234.60, 1.0, 0},
+          {Side::Ask, 1234.70, 0.5, 0}
+        })) REQUIRE_NOTHROW(levels.stats.takerTrades.read_from_gw(it));
+        THEN("values") {
+          REQUIRE(levels.stats.takerTrades.window(60).count == 3);
+          REQUIRE(levels.stats.takerTrades.window(60).buySize == Approx(1.5));
+          REQUIRE(levels.stats.takerTrades.window(60).sellSize == Approx(0.5));
+          REQUIRE(levels.stats.takerTrades.window(60).vwap() == Approx(1234.6));
+          REQUIRE(levels.stats.takerTrades.window(300).count == 3);
+          REQUIRE_FALSE(levels.stats.takerTrades.window(2).count);
+          REQUIRE_NOTHROW(levels.stats.takerTrades.timer_60s());
+          REQUIRE(levels.stats.takerTrades.takersBuySize60s == Approx(1.5));
+          REQUIRE(levels.stats.takerTrades.takersSellSize60s == Approx(0.5));
+        }
+      }
+    }
+
     GIVEN("mBroker") {
       REQUIRE_NOTHROW(qp.mode = mQuotingMode::Top);
       REQUIRE_NOTHROW(qp.autoPositionMode = mAutoPositionMode::Manual);
@@ -725,6 +814,269 @@ namespace ₿ {
         }
       }
     }
+    GIVEN("mTradesHistory") {
+      mTradesHistory &trades = wallet.safety.trades;
+      REQUIRE_NOTHROW(trades.Backup::push = [&]() {
+        INFO("push()");
+      });
+      REQUIRE_NOTHROW(trades.read = [&]() {
+        INFO("read()");
+      });
+      REQUIRE_NOTHROW(qp.safety = mQuotingSafety::Boomerang);
+      REQUIRE_NOTHROW(qp.widthPercentage = false);
+      REQUIRE_NOTHROW(qp.widthPong = 0.01);
+      REQUIRE_NOTHROW(qp.cleanPongsAuto = 0);
+      REQUIRE_NOTHROW(button.cleanTrades.click(nullptr));
+      REQUIRE(trades.empty());
+      const auto Kqty = [&](const Side &side, const Price &price) -> Amount {
+        for (const mOrderFilled &it : trades)
+          if (it.side == side and it.price == price) return it.Kqty;
+        return -1;
+      };
+      const auto tradeId = [&](const Price &price) -> string {
+        for (const mOrderFilled &it : trades)
+          if (it.price == price) return it.tradeId;
+        return "";
+      };
+      for (const Price it : {100.0, 101.0, 102.0})
+        REQUIRE_NOTHROW(trades.insert({it, 1, Side::Ask, false}));
+      WHEN("short ping fair") {
+        REQUIRE_NOTHROW(qp.pongAt = mPongAt::ShortPingFair);
+        REQUIRE_NOTHROW(trades.insert({99.5, 1.5, Side::Bid, true}));
+        THEN("highest pings first") {
+          REQUIRE(trades.size() == 3);
+          REQUIRE(Kqty(Side::Ask, 102) == Approx(1));
+          REQUIRE(Kqty(Side::Ask, 101) == Approx(0.5));
+          REQUIRE(Kqty(Side::Ask, 100) == 0);
+        }
+      }
+      WHEN("long ping fair") {
+        REQUIRE_NOTHROW(qp.pongAt = mPongAt::LongPingFair);
+        REQUIRE_NOTHROW(trades.insert({99.5, 1.5, Side::Bid, true}));
+        THEN("lowest pings first") {
+          REQUIRE(trades.size() == 3);
+          REQUIRE(Kqty(Side::Ask, 100) == Approx(1));
+          REQUIRE(Kqty(Side::Ask, 101) == Approx(0.5));
+          REQUIRE(Kqty(Side::Ask, 102) == 0);
+        }
+      }
+      WHEN("long ping aggressive") {
+        REQUIRE_NOTHROW(qp.pongAt = mPongAt::LongPingAggressive);
+        REQUIRE_NOTHROW(trades.insert({100.985, 2.5, Side::Bid, true}));
+        THEN("only pings wider than widthPong") {
+          REQUIRE(trades.size() == 4);
+          REQUIRE(Kqty(Side::Ask, 100) == 0);
+          REQUIRE(Kqty(Side::Ask, 101) == Approx(1));
+          REQUIRE(Kqty(Side::Ask, 102) == Approx(1));
+          REQUIRE(Kqty(Side::Bid, 100.985) == 0);
+          REQUIRE(trades.openBids.size() == 1);
+          REQUIRE(trades.openBids.begin()->second.quantity == Approx(0.5));
+        }
+      }
+      WHEN("paged by the same pong time") {
+        REQUIRE_NOTHROW(qp.pongAt = mPongAt::LongPingFair);
+        REQUIRE_NOTHROW(trades.insert({99.5, 3, Side::Bid, true}));
+        THEN("every row is visited once") {
+          REQUIRE(trades.size() == 3);
+          json cursor = {{"limit", 1}};
+          vector<string> visited;
+          for (size_t i = 0; i < 3; ++i) {
+            const json page = trades.page(cursor);
+            REQUIRE(page.size() == 1);
+            REQUIRE(find(visited.begin(), visited.end(), page.at(0).value("tradeId", "")) == visited.end());
+            visited.push_back(page.at(0).value("tradeId", ""));
+            cursor["until"] = page.at(0).value("Ktime", (Clock)0);
+            cursor["time"]  = page.at(0).value("time",  (Clock)0);
+          }
+          REQUIRE(trades.page(cursor).empty());
+        }
+      }
+      WHEN("paged by a malformed cursor") {
+        THEN("empty page") {
+          REQUIRE(trades.page(json::object()).size() == 3);
+          REQUIRE(trades.page(json::array()).empty());
+          REQUIRE(trades.page("x").empty());
+          REQUIRE(trades.page({{"until", "x"}}).empty());
+          REQUIRE(trades.page({{"limit", nullptr}}).empty());
+        }
+      }
+      WHEN("cleared in the middle") {
+        REQUIRE_NOTHROW(trades.insert({103, 1, Side::Ask, false}));
+        REQUIRE_NOTHROW(button.cleanTrade.click({{"tradeId", tradeId(101)}}));
+        THEN("the last row takes its place") {
+          REQUIRE(trades.size() == 3);
+          REQUIRE(Kqty(Side::Ask, 101) == -1);
+          REQUIRE(Kqty(Side::Ask, 103) == 0);
+          REQUIRE(trades.openAsks.size() == 3);
+          REQUIRE_NOTHROW(button.cleanTrade.click({{"tradeId", tradeId(103)}}));
+          REQUIRE(trades.size() == 2);
+          REQUIRE(Kqty(Side::Ask, 100) == 0);
+          REQUIRE(Kqty(Side::Ask, 102) == 0);
+          REQUIRE(Kqty(Side::Ask, 103) == -1);
+          REQUIRE(trades.openAsks.size() == 2);
+        }
+        THEN("remaining rows still match") {
+          REQUIRE_NOTHROW(button.cleanTrade.click({{"tradeId", tradeId(103)}}));
+          REQUIRE_NOTHROW(qp.pongAt = mPongAt::LongPingFair);
+          REQUIRE_NOTHROW(trades.insert({99.5, 1.5, Side::Bid, true}));
+          REQUIRE(trades.size() == 2);
+          REQUIRE(Kqty(Side::Ask, 100) == Approx(1));
+          REQUIRE(Kqty(Side::Ask, 102) == Approx(0.5));
+          REQUIRE(trades.openAsks.size() == 1);
+          REQUIRE(trades.openBids.empty());
+          REQUIRE_NOTHROW(button.cleanTrade.click({{"tradeId", tradeId(100)}}));
+          REQUIRE(trades.size() == 1);
+          REQUIRE(Kqty(Side::Ask, 102) == Approx(0.5));
+          REQUIRE(trades.openAsks.size() == 1);
+        }
+      }
+      REQUIRE_NOTHROW(button.cleanTrades.click(nullptr));
+      REQUIRE(trades.empty());
+    }
+#ifndef _WIN32
+    GIVEN("Sqlite::Journal") {
+      static mFairHistory history(K);
+      const string file = "/tmp/K-units." + to_string(Tstamp) + ".series";
+      const auto write = [&](Sqlite::Journal &journal, const Price &fv) {
+        history.rows = {fv};
+        journal.write(&history);
+      };
+      const auto read = [&](const Sqlite::Journal &journal) {
+        history.rows.clear();
+        journal.read(&history);
+        return history.rows;
+      };
+      THEN("not copyable") {
+        REQUIRE_FALSE(is_copy_constructible<Sqlite::Journal>::value);
+        REQUIRE_FALSE(is_copy_assignable<Sqlite::Journal>::value);
+      }
+      WHEN("written") {
+        {
+          Sqlite::Journal journal(file, 1);
+          for (const Price it : {1.0, 2.0, 3.0})
+            REQUIRE_NOTHROW(write(journal, it));
+        }
+        THEN("read after reopen") {
+          Sqlite::Journal journal(file, 1);
+          REQUIRE(read(journal) == vector<Price>({1, 2, 3}));
+        }
+        THEN("reset on different columns") {
+          Sqlite::Journal journal(file, 2);
+          REQUIRE(read(journal).empty());
+        }
+      }
+      WHEN("wrapped around") {
+        Sqlite::Journal journal(file, 1);
+        const size_t capacity = 1 << 17;
+        for (size_t i = 0; i < capacity + 5; ++i)
+          write(journal, i);
+        THEN("oldest rows are overwritten") {
+          const vector<Price> rows = read(journal);
+          REQUIRE(rows.size() == capacity);
+          REQUIRE(rows.front() == 5);
+          REQUIRE(rows.back() == capacity + 4);
+        }
+      }
+      WHEN("expired") {
+        Sqlite::Journal journal(file, 1);
+        REQUIRE_NOTHROW(write(journal, 1));
+        this_thread::sleep_for(chrono::milliseconds(5));
+        const Clock before = Tstamp;
+        REQUIRE_NOTHROW(write(journal, 2));
+        REQUIRE_NOTHROW(journal.expire(before));
+        THEN("older rows are skipped") {
+          REQUIRE(read(journal) == vector<Price>({2}));
+          REQUIRE_NOTHROW(journal.expire(Tstamp + 1));
+          REQUIRE(read(journal).empty());
+        }
+      }
+      remove(file.data());
+    }
+#endif
+
+    GIVEN("mEwma::waitForHistory") {
+      static class: public Loop {
+        public:
+          list<Loop::Async> events;
+        public:
+          void timer_ticks_factor(const unsigned int&) const override {};
+          void timer_1s(const function<void(const unsigned int&)>&) override {};
+          Loop::Async *async(const function<void()> &data) override {
+            events.emplace_back(data);
+            return &events.back();
+          };
+          curl_socket_t poll() override { return 0; };
+          void walk() override {};
+          void end() override {};
+      } loop;
+      static Price fairValue = 0;
+      static mEwma ewma(K, fairValue, qp);
+      REQUIRE_NOTHROW(ewma.fairValue96h.Backup::push = ewma.Backup::push = [&]() {
+        INFO("push()");
+      });
+      REQUIRE_NOTHROW(ewma.fairValue96h.rows.assign(1440, 100));
+      REQUIRE_NOTHROW(ewma.waitForHistory(&loop));
+      REQUIRE_NOTHROW(qp._diffEwma |= 0x3F);
+      REQUIRE_NOTHROW(K.clicked(&qp));
+      THEN("values wait for the loop") {
+        REQUIRE_FALSE(ewma.mgEwmaM);
+        WHEN("the minute timer fires before the loop") {
+          REQUIRE_NOTHROW(fairValue = 200);
+          REQUIRE_NOTHROW(ewma.timer_60s(0));
+          THEN("values") {
+            REQUIRE(ewma.mgEwmaM == 200);
+            REQUIRE(ewma.fairValue96h.size() == 1441);
+            WHEN("the loop receives the reloaded values") {
+              REQUIRE_NOTHROW(loop.events.back().ready());
+              THEN("values include the timer") {
+                const double alpha = 2.0 / (qp.mediumEwmaPeriods + 1);
+                REQUIRE(ewma.mgEwmaM == Approx(alpha * 200 + (1 - alpha) * 100));
+                REQUIRE(ewma.mgEwmaVL == Approx(2.0 / (qp.veryLongEwmaPeriods + 1) * 100 + 100));
+              }
+            }
+          }
+        }
+      }
+    }
+
+    GIVEN("snapshots") {
+      static mOrders saved(K), restored(K);
+      static Price fairValue = 0;
+      static mEwma from(K, fairValue, qp), to(K, fairValue, qp);
+      mOrder order;
+      REQUIRE_NOTHROW(order.orderId = "a");
+      REQUIRE_NOTHROW(order.price = 1234.56);
+      REQUIRE_NOTHROW(order.quantity = 0.5);
+      REQUIRE_NOTHROW(order.status = Status::Waiting);
+      REQUIRE_NOTHROW(saved.upsert(order));
+      REQUIRE_NOTHROW(order.exchangeId = "xa");
+      REQUIRE_NOTHROW(order.status = Status::Working);
+      REQUIRE_NOTHROW(saved.upsert(order));
+      REQUIRE_NOTHROW(order.orderId = "b");
+      REQUIRE_NOTHROW(order.exchangeId = "");
+      REQUIRE_NOTHROW(order.status = Status::Waiting);
+      REQUIRE_NOTHROW(saved.upsert(order));
+      REQUIRE_NOTHROW(from.mgEwmaM = 1234.5);
+      REQUIRE_NOTHROW(from.mgEwmaW = 0.25);
+      REQUIRE_NOTHROW(from.targetPositionAutoPercentage = 42);
+      WHEN("restored") {
+        REQUIRE_NOTHROW(restored.restore(json::from_msgpack(json::to_msgpack(saved.snapshot()))));
+        REQUIRE_NOTHROW(to.restore(json::from_msgpack(json::to_msgpack(from.snapshot()))));
+        THEN("only acknowledged orders") {
+          REQUIRE(restored.working().size() == 1);
+          REQUIRE(restored.find("a"));
+          REQUIRE(restored.find("a")->exchangeId == "xa");
+          REQUIRE(restored.find("a")->price == 1234.56);
+          REQUIRE(restored.find("a")->quantity == 0.5);
+          REQUIRE_FALSE(restored.find("b"));
+        }
+        THEN("all ewma values") {
+          REQUIRE(to.mgEwmaM == 1234.5);
+          REQUIRE(to.mgEwmaW == 0.25);
+          REQUIRE(to.targetPositionAutoPercentage == 42);
+        }
+      }
+    }
   }
 
   SCENARIO_METHOD(BTCEUR, "bugs") {
@@ -786,6 +1138,26 @@ namespace ₿ {
           REQUIRE(abs(actualBaseDelta - expectedBaseDelta) < 0.000000000001);
           REQUIRE(abs(actualQuoteDelta - expectedQuoteDelta) < 0.000000000001);
           REQUIRE(abs(actualDiff - expectedDiff) < 0.000000000001);
+          REQUIRE(wallet.safety.trades.openBids.size() + wallet.safety.trades.openAsks.size() == (size_t)count_if(
+            wallet.safety.trades.begin(), wallet.safety.trades.end(),
+            [](const mOrderFilled &it) { return it.Kqty < it.quantity; }
+          ));
+        }
+        THEN("paged history") {
+          const auto time = [](const json &it) {
+            return it.value("Ktime", (Clock)0) ?: it.value("time", (Clock)0);
+          };
+          const json latest = wallet.safety.trades.hello();
+          REQUIRE(latest.size() == wallet.safety.trades.size());
+          for (size_t i = 1; i < latest.size(); ++i)
+            REQUIRE(time(latest.at(i - 1)) >= time(latest.at(i)));
+          const json older = wallet.safety.trades.page({
+            {"until", time(latest.at(1))},
+            {"limit", 2}
+          });
+          REQUIRE(older.size() == 2);
+          REQUIRE(time(older.at(0)) <= time(latest.at(1)));
+          REQUIRE(time(older.at(1)) <= time(older.at(0)));
         }
       }
     }